@@ -20,14 +20,68 @@
 #include <istream>
 #include <string>
 #include <tuple>
+#include <map>
+#include <algorithm>
+#include <vector>
+#include <limits>
 
 #include "Libs/BigNumTypeTrait.hpp"
 #include "Libs/BigNumMemory.hpp"
 #include "Libs/BigNumFFT.hpp"
 #include "Libs/BigNumModularRing.hpp"
 #include "Libs/BigNumGenerics.hpp"
+#include "Libs/BigNumWord.hpp"
 #include "BigInt/BigIntOutput.hpp"
 #include "BigInt/BigIntInput.hpp"
+#include "BigInt/BigIntMultiplier.hpp"
+#include "BigInt/BigIntDivisor.hpp"
+#include "BigInt/BigIntModular.hpp"
+#include "BigInt/BigIntFixedBasePow.hpp"
+#include "BigInt/BigIntMultiExp.hpp"
+
+// thresholds (in digits of the shorter operand) for choosing multiplication
+// algorithms: basecase, Karatsuba, Toom-Cook and NTT in increasing order. They
+// can be tuned by defining them before including BigNum.hpp. The NTT threshold
+// applies with vectorized NTT kernels and the scalar one on hosts without them.
+#ifndef _BIG_NUM_MUL_BASECASE_THRESHOLD_
+#define _BIG_NUM_MUL_BASECASE_THRESHOLD_ 32
+#endif // _BIG_NUM_MUL_BASECASE_THRESHOLD_
+#ifndef _BIG_NUM_MUL_TOOM3_THRESHOLD_
+#define _BIG_NUM_MUL_TOOM3_THRESHOLD_ 128
+#endif // _BIG_NUM_MUL_TOOM3_THRESHOLD_
+#ifndef _BIG_NUM_MUL_NTT_THRESHOLD_
+#define _BIG_NUM_MUL_NTT_THRESHOLD_ 512
+#endif // _BIG_NUM_MUL_NTT_THRESHOLD_
+#ifndef _BIG_NUM_MUL_NTT_SCALAR_THRESHOLD_
+#define _BIG_NUM_MUL_NTT_SCALAR_THRESHOLD_ 8192
+#endif // _BIG_NUM_MUL_NTT_SCALAR_THRESHOLD_
+
+// thresholds (in digits of the divisor) for choosing division algorithms:
+// schoolbook, Burnikel-Ziegler recursion and Barrett reduction with a Newton
+// reciprocal in increasing order. Like the NTT thresholds, the Barrett one is
+// lower with vectorized NTT kernels. Defining it as 2 selects Barrett reduction
+// for every division by more than a single digit.
+#ifndef _BIG_NUM_DIV_DC_THRESHOLD_
+#define _BIG_NUM_DIV_DC_THRESHOLD_ 32
+#endif // _BIG_NUM_DIV_DC_THRESHOLD_
+#ifndef _BIG_NUM_DIV_BARRETT_THRESHOLD_
+#define _BIG_NUM_DIV_BARRETT_THRESHOLD_ 16384
+#endif // _BIG_NUM_DIV_BARRETT_THRESHOLD_
+#ifndef _BIG_NUM_DIV_BARRETT_SCALAR_THRESHOLD_
+#define _BIG_NUM_DIV_BARRETT_SCALAR_THRESHOLD_ 131072
+#endif // _BIG_NUM_DIV_BARRETT_SCALAR_THRESHOLD_
+
+// threshold (in digits of the modulus) below which powmod multiplies in Montgomery
+// form for odd moduli. Other moduli are reduced by a Divisor.
+#ifndef _BIG_NUM_POWMOD_MONTGOMERY_THRESHOLD_
+#define _BIG_NUM_POWMOD_MONTGOMERY_THRESHOLD_ 192
+#endif // _BIG_NUM_POWMOD_MONTGOMERY_THRESHOLD_
+
+// number of bases from which multiPowmod switches from Straus' interleaved
+// windows to Pippenger's buckets
+#ifndef _BIG_NUM_MULTIEXP_PIPPENGER_THRESHOLD_
+#define _BIG_NUM_MULTIEXP_PIPPENGER_THRESHOLD_ 512
+#endif // _BIG_NUM_MULTIEXP_PIPPENGER_THRESHOLD_
 
 namespace bignum{
 	
@@ -35,8 +89,10 @@ namespace bignum{
 	using _utility::destroyAll;
 	using _type::isRLRef;
 	using _utility::fft1DPower2;
+	using _utility::setThreadCount;
+	using _utility::getThreadCount;
 	
-	template <class Allocator = std::allocator<std::uint32_t>>
+	template <class Allocator = std::allocator<std::uint64_t>>
 	class BigInt{
 	private:
 		using Alloc = Allocator;
@@ -47,18 +103,94 @@ namespace bignum{
 		using SizeT = std::uint32_t;
 		using LogSizeT = std::uint8_t;
 		
+		// every digit is a full machine word
 		using Ele = typename Alloc::value_type;
+		static_assert(std::is_unsigned<Ele>::value, "BigInt digits must be unsigned integers");
+		
+		static constexpr LogSizeT ENTRY_SIZE = std::numeric_limits<Ele>::digits;
+		
+		// scratch digits for multiplication
+		using EleBuffer = std::vector<Ele, Alloc>;
+		
+		// the length of a BigInt is only bounded by SizeT, leaving spare high bits so
+		// that summing or doubling lengths never overflows
+		static constexpr SizeT MAX_LEN = SizeT(1) << (std::numeric_limits<SizeT>::digits - 2);
+		
+		// NTT coefficients. Digits are split into COEF_SIZE-bit pieces on the fly
+		// when being transformed and packed back with carries afterwards.
+		using Coef = std::uint32_t;
+		using CoefAlloc = typename AllocTrait::template rebind_alloc<Coef>;
+		using CoefBuffer = std::vector<Coef, CoefAlloc>;
+		
+		static constexpr LogSizeT COEF_SIZE = (ENTRY_SIZE < 32)? ENTRY_SIZE: 32;
+		static constexpr SizeT COEF_PER_ELE = ENTRY_SIZE / COEF_SIZE;
+		static_assert(ENTRY_SIZE % COEF_SIZE == 0, "digit size must be a multiple of COEF_SIZE");
+		
+		// Convolutions are done modulo three primes and recombined with CRT. A sum
+		// of at most 2 ^ 23 products of 32-bit coefficients is below 2 ^ 87, while
+		// P1 * P2 * P3 is above 2 ^ 89, so the recombined value is exact.
+		static constexpr SizeT PRI_ORDER = 16777216;	// 2 ^ 24, supported by all primes
+		static constexpr Coef P1 = 2013265921;	// 15 * 2 ^ 27 + 1
+		static constexpr Coef OMEGA1 = 1003846038;	// 31 ^ ((P1 - 1) / PRI_ORDER) mod P1
+		static constexpr Coef P2 = 469762049;	// 7 * 2 ^ 26 + 1
+		static constexpr Coef OMEGA2 = 320192759;	// 3 ^ ((P2 - 1) / PRI_ORDER) mod P2
+		static constexpr Coef P3 = 754974721;	// 45 * 2 ^ 24 + 1
+		static constexpr Coef OMEGA3 = 739831874;	// 11 ^ ((P3 - 1) / PRI_ORDER) mod P3
+		
+		static constexpr Coef P1_INV_P2 = 163395495;	// P1 ^ (-1) mod P2
+		static constexpr Coef P1P2_INV_P3 = 666154164;	// (P1 * P2) ^ (-1) mod P3
+		
+		using ModularP1 = _utility::ModularP<SizeT, Coef, P1, OMEGA1>;
+		using ModularP2 = _utility::ModularP<SizeT, Coef, P2, OMEGA2>;
+		using ModularP3 = _utility::ModularP<SizeT, Coef, P3, OMEGA3>;
+		
+		// a convolution held modulo each of the three primes
+		struct CoefBuffers{
+		public:
+			explicit CoefBuffers(const Alloc &_alloc)
+				:c1{CoefAlloc(_alloc)}, c2{CoefAlloc(_alloc)}, c3{CoefAlloc(_alloc)}{}
+			
+			CoefBuffer c1, c2, c3;
+		};
+		
+		// forward transforms of an operand that is multiplied by many others, e.g. the
+		// divisor and its reciprocal in a long division. Entries are keyed by the
+		// digits and the transform shape, so the operand must stay unchanged while
+		// the cache is in use.
+		struct TransformCache{
+		public:
+			struct Entry{
+			public:
+				explicit Entry(const Alloc &_alloc)
+					:coefs(_alloc), tail(_alloc){}
+				
+				CoefBuffers coefs, tail;
+			};
+			
+			std::map<std::tuple<const Ele *, SizeT, SizeT, SizeT>, Entry> entries;
+		};
 		
-		static constexpr SizeT MAX_LEN = 32768;
-		static constexpr SizeT PRI_ORDER = 134217728;
-		//static constexpr SizeT MAX_LEN = 134217728;	// 2 ^ 27
-		static constexpr Ele P = 2013265921;	// 15 * MAX_LEN + 1
-		static constexpr Ele OMEGA = 440564289;	// 31 ^ 15 mod P
-		static constexpr LogSizeT ENTRY_SIZE = 8;
-		//static constexpr LogSizeT ENTRY_SIZE = 15;	// floor(log(p) / 2)
-		static constexpr Ele TWO_INV = 1006632961;	// 2 ^ (-1) mod P
+		// what is kept of a divisor that divides many numbers. norm holds its digits
+		// shifted to set the top bit when useRecursiveDivision() holds for it, miu
+		// its reciprocal newtonInverse(2 * n * ENTRY_SIZE) otherwise, and the caches
+		// the transforms of both.
+		struct DivisorHint{
+		public:
+			const Ele *norm;
+			const BigInt *miu;
+			TransformCache *rhsCache, *miuCache;
+		};
 		
-		using ModularP_T = _utility::ModularP<SizeT, Ele, P, OMEGA>;
+		// _rhs >> ENTRY_SIZE, still well-defined when _rhs is exactly as wide as Ele
+		template <typename Unsigned>
+		inline static Unsigned shrEntry(Unsigned _rhs) noexcept{
+			return (_rhs >> (ENTRY_SIZE - 1)) >> 1;
+		}
+		// _rhs << ENTRY_SIZE
+		template <typename Unsigned>
+		inline static Unsigned shlEntry(Unsigned _rhs) noexcept{
+			return (_rhs << (ENTRY_SIZE - 1)) << 1;
+		}
 		
 		// wrapper for Ptr to simpfy array operations
 		struct DigitBuffer{
@@ -301,69 +433,52 @@ namespace bignum{
 				return 0;
 			}
 			
+			// compare with an unsigned integer that could be hold in dLen digits
 			template <typename UnsignedInt, SizeT dLen>
 			inline std::int8_t compareUnsignedIntBuffer(UnsignedInt _rhs, std::integral_constant<SizeT, dLen>) const{
 				if(len > dLen){
 					return 1;
 				}
 				
-				return compareUnsignedIntRaw(_rhs, std::integral_constant<SizeT, dLen>());
-			}
-			// overload for small unsigned types
-			template <typename UnsignedInt>
-			inline std::int8_t compareUnsignedIntBuffer(UnsignedInt _rhs, std::integral_constant<SizeT, 1>) const{
-				if(data[0] < _rhs){
-					return -1;
+				using Common = typename std::common_type<Ele, UnsignedInt>::type;
+				
+				Ele digits[dLen];
+				Common tmp = _rhs;
+				for(SizeT i(0);i < dLen;++i, tmp = shrEntry(tmp)){
+					digits[i] = static_cast<Ele>(tmp);
 				}
-				if(data[0] > _rhs){
-					return 1;
+				for(SizeT i = dLen;i > 0;--i){
+					Ele cur = (i <= len)? data[i - 1]: Ele(0);
+					if(cur > digits[i - 1]){
+						return 1;
+					}
+					if(cur < digits[i - 1]){
+						return -1;
+					}
 				}
 				return 0;
 			}
 			
-			Ele propagateCarryRange(SizeT st, SizeT en){
-				Ele carry(0);
-				for(SizeT i(st);i < en;++i){
-					data[i] += carry;
-					carry = data[i] >> ENTRY_SIZE;
-					data[i] -= carry << ENTRY_SIZE;
-				}
-				return carry;
-			}
-			
-			inline void propagateCarry(){
-				Ele carry = propagateCarryRange(0, len);
-				
-				SizeT expand(0);
-				for(Ele tmp = carry;tmp > 0;tmp >>= ENTRY_SIZE, ++expand);
-				SizeT _len = len;
-				// simple hack. TODO: manually resize and construct carries
-				resize(len + expand);
-				for(SizeT i = _len;i < len;++i){
-					data[i] = carry & ((1 << ENTRY_SIZE) - 1);
-					carry >>= ENTRY_SIZE;
-				}
-			}
-			
 			// thisRaw += _rhsRaw
 			inline void addRaw(const DigitBuffer &_rhs){
-				// simple hack
 				if(len < _rhs.len){
 					resize(_rhs.len);
 				}
-				for(SizeT i(0);i < _rhs.len;++i){
-					data[i] += _rhs.data[i];
+				
+				Ele carry = _utility::addDigits(data, data, _rhs.data, _rhs.len);
+				carry = _utility::addDigit(data + _rhs.len, data + _rhs.len, len - _rhs.len, carry);
+				if(Ele(0) != carry){
+					resize(len + 1);
+					data[len - 1] = carry;
 				}
-				propagateCarry();
 			}
 			inline void addRaw(DigitBuffer &&_rhs){
-				if(len < _rhs.len){
-					resize(_rhs.len);
-				}
-				for(SizeT i = 0;i < _rhs.len;++i){
-					data[i] += std::move(_rhs.data[i]);
-				}
-				propagateCarry();
+				addRaw(static_cast<const DigitBuffer &>(_rhs));
+			}
+			
+			// the digits alone represent 0, no matter what the sign is
+			inline bool isZero() const{
+				return (1 == len) && (Ele(0) == data[0]);
 			}
 			
 			inline void shrinkToFit(){
@@ -385,113 +500,20 @@ namespace bignum{
 			// thisRaw -= _rhsRaw
 			// assert(thisRaw >= _rhsRaw)
 			void subRaw(const DigitBuffer &_rhs){
-				Ele carry(0);
 				assert(len >= _rhs.len);
 				
-				for(SizeT i(0);i < _rhs.len;++i){
-					assert(data[i] + (1 << ENTRY_SIZE) >= _rhs.data[i] + carry);
-					if(data[i] < (_rhs.data[i] + carry)){
-						data[i] += (1 << ENTRY_SIZE) - (_rhs.data[i] + carry);
-						carry = Ele(1);
-					}
-					else{
-						data[i] -= _rhs.data[i] + carry;
-						carry = Ele(0);
-					}
-				}
-				
-				for(SizeT i = _rhs.len;i < len;++i){
-					assert(data[i] + (1 << ENTRY_SIZE) >= carry);
-					if(data[i] < carry){
-						data[i] += (1 << ENTRY_SIZE) - carry;
-						carry = Ele(1);
-					}
-					else{
-						data[i] -= carry;
-						carry = Ele(0);
-						break;
-					}
-				}
-				if(Ele(0) != carry){
+				Ele borrow = _utility::subDigits(data, data, _rhs.data, _rhs.len);
+				borrow = _utility::subDigit(data + _rhs.len, data + _rhs.len, len - _rhs.len, borrow);
+				if(Ele(0) != borrow){
 					throw std::underflow_error("left operand less than right operand.");
 				}
 				
 				shrinkToFit();
 			}
 			void subRaw(DigitBuffer &&_rhs){
-				Ele carry(0);
-				assert(len >= _rhs.len);
-				
-				for(SizeT i(0);i < _rhs.len;++i){
-					assert(data[i] + (1 << ENTRY_SIZE) >= _rhs.data[i] + carry);
-					if(data[i] < (_rhs.data[i] + carry)){
-						data[i] += (1 << ENTRY_SIZE) - (std::move(_rhs.data[i]) + carry);
-						carry = Ele(1);
-					}
-					else{
-						data[i] -= std::move(_rhs.data[i]) + carry;
-						carry = Ele(0);
-					}
-				}
-				
-				for(SizeT i = _rhs.len;i < len;++i){
-					assert(data[i] + (1 << ENTRY_SIZE) >= carry);
-					if(data[i] < carry){
-						data[i] += (1 << ENTRY_SIZE) - carry;
-						carry = Ele(1);
-					}
-					else{
-						data[i] -= carry;
-						carry = Ele(0);
-						break;
-					}
-				}
-				if(Ele(0) != carry){
-					throw std::underflow_error("left operand less than right operand.");
-				}
-				
-				shrinkToFit();
-			}
-		private:
-			// TODO: rewite this function using std::integer_sequence instead of raw
-			// "recursion"
-			template <typename UnsignedInt, SizeT dLen>
-			inline std::int8_t compareUnsignedIntRaw(UnsignedInt _rhs, std::integral_constant<SizeT, dLen>) const{
-				Ele digit = (_rhs >> ((dLen - 1) * ENTRY_SIZE)) & ((1 << ENTRY_SIZE) - 1);
-				if((digit > 0)){
-					if(len < dLen){
-						return -1;
-					}
-					if(data[dLen - 1] < digit){
-						return -1;
-					}
-					if(data[dLen - 1] > digit){
-						return 1;
-					}
-					return compareUnsignedIntRaw(_rhs, std::integral_constant<SizeT, dLen - 1>());
-				}
-				else{
-					if(len < dLen){
-						return compareUnsignedIntRaw(_rhs, std::integral_constant<SizeT, dLen - 1>());
-					}
-					if(data[dLen - 1] > 0){
-						return 1;
-					}
-					return compareUnsignedIntRaw(_rhs, std::integral_constant<SizeT, dLen - 1>());
-				}
-			}
-			// note: this is an overload.
-			template <typename UnsignedInt>
-			inline std::int8_t compareUnsignedIntRaw(UnsignedInt _rhs, std::integral_constant<SizeT, 0>) const{
-				if(data[0] < _rhs){
-					return -1;
-				}
-				if(data[0] > _rhs){
-					return 1;
-				}
-				return 0;
+				subRaw(static_cast<const DigitBuffer &>(_rhs));
 			}
-		public:			
+		public:
 			Alloc *alloc;
 			Ptr data;
 			SizeT len, cap;
@@ -534,12 +556,39 @@ namespace bignum{
 		template <class, class>
 		friend class _type::LiteralParser;
 		
+		template <class>
+		friend class bignum::PreparedMultiplier;
+		
+		template <class>
+		friend class bignum::Divisor;
+		
+		template <class>
+		friend class _type::MontgomeryRing;
+		
+		template <class>
+		friend class _type::DivisorRing;
+		
+		template <class, class>
+		friend class _type::CombTable;
+		
+		template <class>
+		friend class bignum::FixedBasePow;
+		
+		template <class, class>
+		friend class _type::MultiExp;
+		
 		template <typename Digit>
 		using RadixConvertEnumer = RadixConvertEnumer<Digit, BigInt>;
 		
 		template <typename Digit>
 		using RadixConvertRecver = RadixConvertRecver<Digit, BigInt>;
 		
+		using PreparedMultiplier = bignum::PreparedMultiplier<BigInt>;
+		
+		using Divisor = bignum::Divisor<BigInt>;
+		
+		using FixedBasePow = bignum::FixedBasePow<BigInt>;
+		
 		template <typename Digit>
 		using DigitRecvIterator = _type::DigitRecvIterator<Digit, BigInt>;
 		
@@ -791,7 +840,7 @@ namespace bignum{
 		template <typename Integer, 
 			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr>
 		BigInt &operator>>=(Integer _rhs){
-			shl(_rhs, std::integral_constant<bool, isSigned<Integer>::value>());
+			shr(_rhs, std::integral_constant<bool, isSigned<Integer>::value>());
 			return *this;
 		}
 		
@@ -952,6 +1001,271 @@ namespace bignum{
 			return tmp;
 		}
 		
+		// this = this * this, which is cheaper than a general multiplication
+		inline BigInt &square(){
+			selfMultiply();
+			return *this;
+		}
+		inline friend BigInt square(const BigInt &_rhs){
+			BigInt tmp = _rhs;
+			tmp.square();
+			return tmp;
+		}
+		inline friend BigInt square(BigInt &&_rhs){
+			BigInt tmp = std::move(_rhs);
+			tmp.square();
+			return tmp;
+		}
+		
+		// _base ^ _exp mod |_mod| in [0, |_mod|) for a non-negative _exp. A negative
+		// _base is taken as its non-negative residue.
+		inline friend BigInt powmod(const BigInt &_base, const BigInt &_exp, const BigInt &_mod){
+			if(_mod.isZero()){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			if(!_exp.positive){
+				throw std::domain_error("negative exponent");
+				// errno = EDOM;
+			}
+			
+			BigInt m = _mod;
+			m.positive = true;
+			if((1 == m.buf.len) && (Ele(1) == m.buf.data[0])){
+				return BigInt();
+			}
+			if(_exp.isZero()){
+				return BigInt(Ele(1));
+			}
+			
+			BigInt b = _base % m;
+			if(!b.positive){
+				b += m;
+			}
+			if(b.isZero()){
+				return b;
+			}
+			if(useMontgomery(m)){
+				_type::MontgomeryRing<BigInt> ring(m);
+				return powModRing(ring, b, _exp);
+			}
+			_type::DivisorRing<BigInt> ring(m);
+			return powModRing(ring, b, _exp);
+		}
+		
+		// _base ^ _exp for a non-negative native integer _exp, 0 ^ 0 being 1
+		template <class BigIntRef, typename Integer, 
+			typename std::enable_if<isRLRef<BigInt, BigIntRef &&>::value>::type * = nullptr, 
+			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr>
+		inline friend BigInt pow(BigIntRef &&_base, Integer _exp){
+			return BigInt(std::forward<BigIntRef>(_base)).powBy(_exp, 
+				std::integral_constant<bool, isSigned<Integer>::value>{});
+		}
+		
+		// prod _bases[i] ^ _exps[i] mod |_mod| in [0, |_mod|) for non-negative
+		// exponents, with the squarings shared by all the powers. Negative bases are
+		// taken as their non-negative residues.
+		inline friend BigInt multiPowmod(const std::vector<BigInt> &_bases, const std::vector<BigInt> &_exps, const BigInt &_mod){
+			if(_bases.size() != _exps.size()){
+				throw std::domain_error("multiPowmod: numbers of bases and exponents differ");
+				// errno = EDOM;
+			}
+			if(_mod.isZero()){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			for(const BigInt &_exp: _exps){
+				if(!_exp.positive){
+					throw std::domain_error("negative exponent");
+					// errno = EDOM;
+				}
+			}
+			
+			BigInt m = _mod;
+			m.positive = true;
+			if((1 == m.buf.len) && (Ele(1) == m.buf.data[0])){
+				return BigInt();
+			}
+			
+			// powers with zero exponents are 1
+			std::vector<BigInt> bases;
+			std::vector<const BigInt *> exps;
+			for(std::size_t i = 0;i < _bases.size();++i){
+				if(_exps[i].isZero()){
+					continue;
+				}
+				BigInt b = _bases[i] % m;
+				if(!b.positive){
+					b += m;
+				}
+				bases.push_back(std::move(b));
+				exps.push_back(&_exps[i]);
+			}
+			if(bases.empty()){
+				return BigInt(Ele(1));
+			}
+			
+			bool pippenger = (bases.size() >= _BIG_NUM_MULTIEXP_PIPPENGER_THRESHOLD_);
+			if(useMontgomery(m)){
+				_type::MontgomeryRing<BigInt> ring(m);
+				using Method = _type::MultiExp<BigInt, _type::MontgomeryRing<BigInt>>;
+				return pippenger? Method::pippenger(ring, bases, exps): Method::straus(ring, bases, exps);
+			}
+			_type::DivisorRing<BigInt> ring(m);
+			using Method = _type::MultiExp<BigInt, _type::DivisorRing<BigInt>>;
+			return pippenger? Method::pippenger(ring, bases, exps): Method::straus(ring, bases, exps);
+		}
+		
+		// floor(sqrt(_rhs)) for a non-negative _rhs
+		inline friend BigInt isqrt(const BigInt &_rhs){
+			return _rhs.sqrtRem().first;
+		}
+		// (s, r) for a non-negative _rhs = s ^ 2 + r, s = floor(sqrt(_rhs))
+		inline friend std::pair<BigInt, BigInt> isqrtRem(const BigInt &_rhs){
+			return _rhs.sqrtRem();
+		}
+		// the _k-th root of _rhs truncated towards 0, for _k > 0. _rhs must not be
+		// negative if _k is even.
+		template <typename Integer, 
+			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr>
+		inline friend BigInt iroot(const BigInt &_rhs, Integer _k){
+			if(!(_k > Integer(0))){
+				throw std::domain_error("iroot: the degree must be positive");
+				// errno = EDOM;
+			}
+			if(!_rhs.positive && (Integer(0) == (_k & Integer(1)))){
+				throw std::domain_error("even root of a negative number");
+				// errno = EDOM;
+			}
+			
+			BigInt res = _rhs;
+			res.positive = true;
+			SizeT lenBin = res.lenOfBinary();
+			if(std::uintmax_t(_k) >= lenBin){
+				// |_rhs| < 2^{_k}
+				res = BigInt(Ele(res.isZero()? 0: 1));
+			}
+			else if(Integer(1) != _k){
+				res = res.rootBy(static_cast<SizeT>(_k));
+			}
+			res.positive = _rhs.positive || res.isZero();
+			return res;
+		}
+		
+		// whether _rhs = a ^ 2 for an integer a. Most non-squares are rejected by
+		// their residues modulo 64 and a few small odd numbers before any root is
+		// taken.
+		inline friend bool isPerfectSquare(const BigInt &_rhs){
+			if(!_rhs.positive){
+				return false;
+			}
+			static const Ele mask64 = squareResidues(64);
+			if(Ele(0) == ((mask64 >> (_rhs.buf.data[0] & Ele(63))) & Ele(1))){
+				return false;
+			}
+			
+			static const Ele masks[] = {
+				squareResidues(63), squareResidues(17), squareResidues(19), squareResidues(23), 
+				squareResidues(29), squareResidues(31), squareResidues(37), squareResidues(41), 
+				squareResidues(43), squareResidues(47), squareResidues(53), squareResidues(59)
+			};
+			static const Ele moduli[] = {63, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59};
+			// the product of all the moduli is below 2^{62}
+			Ele prod(1);
+			for(Ele q: moduli){
+				prod *= q;
+			}
+			Ele r = _rhs % prod;
+			for(std::size_t i = 0;i < sizeof(moduli) / sizeof(Ele);++i){
+				if(Ele(0) == ((masks[i] >> (r % moduli[i])) & Ele(1))){
+					return false;
+				}
+			}
+			return _rhs.sqrtRem().second.isZero();
+		}
+		// whether _rhs = a ^ k for integers a and k > 1, which holds for 0, 1 and -1.
+		// A k-th power is a p-th power for every prime p dividing k, so only prime
+		// exponents are tried, and a negative _rhs needs an odd p.
+		// 
+		// p has to divide the multiplicity of every prime factor. If _rhs is even, or
+		// has an odd factor below 2^{lg}, that leaves the primes dividing one
+		// multiplicity. Otherwise the root is at least 2^{lg}, so p < lenOfBinary() /
+		// lg, and those p are filtered by power residues computed in one remainder
+		// tree together with the trial division.
+		inline friend bool isPerfectPower(const BigInt &_rhs){
+			constexpr SizeT MAX_LG = 16;
+			
+			BigInt n = _rhs;
+			n.positive = true;
+			SizeT lenBin = n.lenOfBinary();
+			if(lenBin <= 1){
+				return true;
+			}
+			if(_rhs.positive && isPerfectSquare(n)){
+				return true;
+			}
+			
+			SizeT twos(0);
+			for(;Ele(0) == n.buf.data[twos / ENTRY_SIZE];twos += ENTRY_SIZE){}
+			for(Ele w = n.buf.data[twos / ENTRY_SIZE];Ele(0) == (w & Ele(1));w >>= 1){
+				++twos;
+			}
+			if(twos > 0){
+				return n.isOddPowerDividing(twos);
+			}
+			
+			SizeT lg = 1;
+			for(;(lg < MAX_LG) && ((SizeT(1) << (lg + 1)) <= lenBin);++lg){}
+			SizeT maxP = (lenBin - 1) / lg;
+			std::vector<char> composite = oddComposites(std::max<SizeT>(SizeT(1) << lg, maxP + 1));
+			
+			// moduli are packed into words, where modulus i divides words[wordOf[i]]
+			std::vector<Ele> words, moduli;
+			std::vector<std::size_t> wordOf;
+			auto addModulus = [&words, &moduli, &wordOf](Ele q){
+				if(words.empty() || (words.back() > std::numeric_limits<Ele>::max() / q)){
+					words.push_back(Ele(1));
+				}
+				words.back() *= q;
+				moduli.push_back(q);
+				wordOf.push_back(words.size() - 1);
+			};
+			for(SizeT d = 3;d < (SizeT(1) << lg);d += 2){
+				if(0 == composite[d]){
+					addModulus(d);
+				}
+			}
+			std::size_t trials = moduli.size();
+			std::vector<SizeT> exponents;
+			for(SizeT p = 3;p <= maxP;p += 2){
+				if(0 == composite[p]){
+					exponents.push_back(p);
+					Ele q = powerModulus(p, 1);
+					addModulus(q);
+					addModulus(powerModulus(p, q));
+				}
+			}
+			
+			std::vector<Ele> res = n.residues(words);
+			for(std::size_t i = 0;i < trials;++i){
+				if(Ele(0) == res[wordOf[i]] % moduli[i]){
+					return n.isOddPowerDividing(n.multiplicity(moduli[i]));
+				}
+			}
+			for(std::size_t i = 0;i < exponents.size();++i){
+				SizeT p = exponents[i];
+				std::size_t k = trials + 2 * i;
+				if(!isPowerResidue(res[wordOf[k]] % moduli[k], p, moduli[k]) || 
+					!isPowerResidue(res[wordOf[k + 1]] % moduli[k + 1], p, moduli[k + 1])){
+					continue;
+				}
+				if(pow(n.rootBy(p), p) == n){
+					return true;
+				}
+			}
+			return false;
+		}
+		
 		// A = q * B + r no matter whether A or B is negative or not
 		// self divide
 		inline BigInt &operator/=(BigInt &_rhs){
@@ -961,7 +1275,7 @@ namespace bignum{
 				positive = true;
 				_rhs.positive = true;
 				std::tie(*this, std::ignore) = std::move(*this).divideBy(_rhs);
-				positive = _positive1 == _positive2;
+				positive = (_positive1 == _positive2) || buf.isZero();
 				_rhs.positive = _positive2;
 				return *this;
 			}
@@ -980,7 +1294,7 @@ namespace bignum{
 			positive = true;
 			_rhs.positive = true;
 			std::tie(*this, std::ignore) = std::move(*this).divideBy(std::move(_rhs));
-			positive = _positive;
+			positive = _positive || buf.isZero();
 			return *this;
 		}
 		inline BigInt &operator/=(const BigInt &_rhs){
@@ -989,7 +1303,7 @@ namespace bignum{
 					bool _positive = positive;
 					positive = true;
 					std::tie(*this, std::ignore) = std::move(*this).divideBy(_rhs);
-					positive = _positive;
+					positive = _positive || buf.isZero();
 					return *this;
 				}
 				else{
@@ -998,7 +1312,7 @@ namespace bignum{
 					BigInt tmp = _rhs;
 					tmp.changeSign();
 					std::tie(*this, std::ignore) = std::move(*this).divideBy(tmp);
-					positive = _positive;
+					positive = _positive || buf.isZero();
 					return *this;
 				}
 			}
@@ -1014,7 +1328,7 @@ namespace bignum{
 		}
 		template <typename Integer, 
 			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr>
-		inline BigInt &operator/=(Integer &_rhs){
+		inline BigInt &operator/=(Integer _rhs){
 			if(_rhs == 0){
 				throw std::domain_error("divide by zero");
 				// errno = ERANGE;
@@ -1041,7 +1355,7 @@ namespace bignum{
 				throw std::domain_error("divide by zero");
 				// errno = ERANGE;
 			}
-			BigInt res(nullptr);
+			BigInt res(NullTag{});
 			std::tie(res, std::ignore) = std::forward<BigIntRef>(_lhs).divideByInt(_rhs, 
 				std::integral_constant<bool, isSigned<Integer>::value>{});
 			return res;
@@ -1064,7 +1378,7 @@ namespace bignum{
 			positive = true;
 			_rhs.positive = true;
 			*this = std::move(*this).modularBy(std::move(_rhs));
-			positive = _positive;
+			positive = _positive || buf.isZero();
 			return *this;
 		}
 		inline BigInt &operator%=(BigInt &_rhs){
@@ -1074,7 +1388,7 @@ namespace bignum{
 				positive = true;
 				_rhs.positive = true;
 				*this = std::move(*this).modularBy(_rhs);
-				positive = _positive1;
+				positive = _positive1 || buf.isZero();
 				_rhs.positive = _positive2;
 				return *this;
 			}
@@ -1095,7 +1409,7 @@ namespace bignum{
 					tmp.changeSign();
 					*this = std::move(*this).modularBy(tmp);
 				}
-				positive = _positive;
+				positive = _positive || buf.isZero();
 				return *this;
 			}
 			else{
@@ -1120,8 +1434,8 @@ namespace bignum{
 				throw std::domain_error("divide by zero");
 				// errno = ERANGE;
 			}
-			return std::forward<BigIntRef>(_lhs).divideByInt(_rhs, 
-				std::integral_constant<bool, isSigned<Integer>::value>{}).second;
+			return std::forward<BigIntRef>(_lhs).modularByInt(_rhs, 
+				std::integral_constant<bool, isSigned<Integer>::value>{});
 		}
 		template<typename Integer, class BigIntRef, 
 			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr, 
@@ -1135,6 +1449,45 @@ namespace bignum{
 				std::integral_constant<bool, isSigned<Integer>::value>{}).second;
 		}
 		
+		// the results of operator/ and operator% from one division. The remainder
+		// takes the digits of an rvalue dividend.
+		template <class BigIntRef1, class BigIntRef2, 
+			typename std::enable_if<isRLRef<BigInt, BigIntRef1 &&>::value>::type * = nullptr, 
+			typename std::enable_if<isRLRef<BigInt, BigIntRef2 &&>::value>::type * = nullptr>
+		inline friend std::pair<BigInt, BigInt> divmod(BigIntRef1 &&_lhs, BigIntRef2 &&_rhs){
+			if(static_cast<const void *>(&_lhs) == static_cast<const void *>(&_rhs)){
+				if(_rhs.isZero()){
+					throw std::domain_error("divide by zero");
+					// errno = ERANGE;
+				}
+				return std::pair<BigInt, BigInt>(std::piecewise_construct_t{}, 
+					std::tuple<Ele>(1), std::tuple<Ele>(0));
+			}
+			return BigInt(std::forward<BigIntRef1>(_lhs)).divideSigned(std::forward<BigIntRef2>(_rhs));
+		}
+		template <class BigIntRef, typename Integer, 
+			typename std::enable_if<isRLRef<BigInt, BigIntRef &&>::value>::type * = nullptr, 
+			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr>
+		inline friend std::pair<BigInt, Integer> divmod(BigIntRef &&_lhs, Integer _rhs){
+			if(_rhs == 0){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			return std::forward<BigIntRef>(_lhs).divideByInt(_rhs, 
+				std::integral_constant<bool, isSigned<Integer>::value>{});
+		}
+		template<typename Integer, class BigIntRef, 
+			typename std::enable_if<std::is_integral<Integer>::value>::type * = nullptr, 
+			typename std::enable_if<isRLRef<BigInt, BigIntRef &&>::value>::type * = nullptr>
+		inline friend std::pair<Integer, Integer> divmod(Integer _lhs, BigIntRef &&_rhs){
+			if(_rhs.isZero()){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			return std::forward<BigIntRef>(_rhs).divideOfInt(_lhs, 
+				std::integral_constant<bool, isSigned<Integer>::value>{});
+		}
+		
 		// input
 		template <typename Char, class Trait>
 		friend std::basic_istream<Char, Trait> &operator>>(std::basic_istream<Char, Trait> &is, BigInt &_rhs){
@@ -1169,7 +1522,7 @@ namespace bignum{
 				bool _positive = true;
 				
 				if(Tr::eq_int_type(Tr::to_int_type(_BIG_NUM_GENERIC_LITERAL_(Char, '-')), _st)){
-					bool _positive = true;
+					_positive = false;
 					is.ignore();
 					_st = is.peek();
 					if(Tr::eq_int_type(_st, Tr::eof())){
@@ -1242,7 +1595,7 @@ namespace bignum{
 					_ExactDigitAutomatic<Ele, BigInt, SizeT, std::input_iterator_tag>, 
 					_SmallPower2RadixAutomatic<Ele, BigInt, SizeT, std::input_iterator_tag>>::type;
 				Automatic automatic(4);
-				_ThousandSepParser<Char, Trait> _parser(is, hexDigit, hexDigit + 16, ctypeFacet, npFacet);
+				_ThousandSepParser<Char, Trait> _parser(is, hexDigit, hexDigit + 22, ctypeFacet, npFacet);
 				if(Tr::eq_int_type(Tr::to_int_type(_BIG_NUM_GENERIC_LITERAL_(Char, '0')), _st)){
 					is.ignore();
 					_st = is.peek();
@@ -1483,20 +1836,11 @@ namespace bignum{
 		// case for unsigned integer
 		template <typename Integer>
 		void assignIntegral(Integer _rhs, std::false_type){
-			if(Integer(0) == _rhs){
-				buf.len = 1;
-				buf.cap = 1;
-				buf.data = allocator.allocate(1);
-				allocator.construct(buf.data + 0, Ele(0));
-				positive = true;
-				return ;
-			}
-			
 			using Common = typename std::common_type<Ele, Integer>::type;
 			
 			{
-				Common tmp = _rhs;
-				for(buf.len = 0;tmp > Common(0);++buf.len, tmp >>= ENTRY_SIZE);
+				Common tmp = shrEntry(static_cast<Common>(_rhs));
+				for(buf.len = 1;tmp > Common(0);++buf.len, tmp = shrEntry(tmp));
 				buf.setCap();
 				buf.data = allocator.allocate(static_cast<std::size_t>(buf.cap));
 			}
@@ -1504,8 +1848,8 @@ namespace bignum{
 				Common tmp = _rhs;
 				SizeT i(0);
 				try{
-					for(;tmp > Common(0);++i, tmp >>= ENTRY_SIZE){
-						allocator.construct(buf.data + i, static_cast<Ele>(tmp & ((1 << ENTRY_SIZE) - 1)));
+					for(;i < buf.len;++i, tmp = shrEntry(tmp)){
+						allocator.construct(buf.data + i, static_cast<Ele>(tmp));
 					}
 				}
 				catch(...){
@@ -1522,62 +1866,17 @@ namespace bignum{
 		// case for signed integer
 		template <typename Integer>
 		void assignIntegral(Integer _rhs, std::true_type){
-			if(Integer(0) == _rhs){
-				buf.len = 1;
-				buf.cap = 1;
-				buf.data = allocator.allocate(1);
-				allocator.construct(buf.data + 0, Ele(0));
-				positive = true;
-				return ;
-			}
+			using Unsigned = typename std::make_unsigned<Integer>::type;
 			
-			if(Integer(1 << (sizeof(Integer) * CHAR_BIT - 1)) == _rhs){
-				buf.setLen(static_cast<SizeT>((sizeof(Integer) * CHAR_BIT - 1 + ENTRY_SIZE - 1) / ENTRY_SIZE));
-				buf.data = allocator.allocate(static_cast<std::size_t>(buf.cap));
-				SizeT i(0);
-				try{
-					for(;i + 1 < buf.len;++i){
-						allocator.construct(buf.data + i, Ele(0));
-					}
-					i = buf.len - 1;
-					allocator.construct(buf.data + buf.len - 1, 1 << ((sizeof(Integer) + ENTRY_SIZE - 1) % ENTRY_SIZE));
-				}
-				catch(...){
-					destroyAll(buf.data, buf.data + i, allocator);
-					allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-					buf.data = nullptr;
-					buf.zeroLen();
-					throw ;
-				}
-				positive = false;
-				return ;
+			// negate in unsigned arithmetic so that the minimum value needs no
+			// special care
+			Unsigned magnitude = static_cast<Unsigned>(_rhs);
+			if(_rhs < Integer(0)){
+				magnitude = static_cast<Unsigned>(Unsigned(0) - magnitude);
 			}
 			
-			using Common = typename std::common_type<Ele, Integer>::type;
-			
-			positive = _rhs > Integer(0);
-			{
-				Common tmp = positive? _rhs: -_rhs;
-				for(buf.len = 0;tmp > Common(0);++buf.len, tmp >>= ENTRY_SIZE);
-				buf.setCap();
-				buf.data = allocator.allocate(static_cast<std::size_t>(buf.cap));
-			}
-			{
-				Common tmp = positive? _rhs: -_rhs;
-				SizeT i(0);
-				try{
-					for(;tmp > Common(0);++i, tmp >>= ENTRY_SIZE){
-						allocator.construct(buf.data + i, static_cast<Ele>(tmp & ((1 << ENTRY_SIZE) - 1)));
-					}
-				}
-				catch(...){
-					destroyAll(buf.data, buf.data + i, allocator);
-					allocator.deallocate(buf.data, buf.cap);
-					buf.data = nullptr;
-					buf.zeroLen();
-					throw ;
-				}
-			}
+			assignIntegral(magnitude, std::false_type{});
+			positive = _rhs >= Integer(0);
 		}
 		
 		void assignLv(const BigInt &_rhs, std::false_type){
@@ -1851,7 +2150,12 @@ namespace bignum{
 		}
 		
 		inline std::int8_t compare(const BigInt &_rhs) const{
-			return buf.compareRaw(_rhs.buf);
+			if(positive != _rhs.positive){
+				return positive? 1: -1;
+			}
+			
+			std::int8_t res = buf.compareRaw(_rhs.buf);
+			return positive? res: static_cast<std::int8_t>(-res);
 		}
 		
 		// compare with unsigned integer
@@ -1873,10 +2177,12 @@ namespace bignum{
 				if(positive){
 					return 1;
 				}
-				// a simple hack. may contain bugs
-				return -buf.compareUnsignedIntBuffer(static_cast<Unsigned>((~_rhs) + 1), 
+				return -buf.compareUnsignedIntBuffer(static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(_rhs)), 
 					std::integral_constant<SizeT, (sizeof(Unsigned) * CHAR_BIT + ENTRY_SIZE - 1) / ENTRY_SIZE>());
 			}
+			if(!positive){
+				return -1;
+			}
 			
 			return buf.compareUnsignedIntBuffer(static_cast<Unsigned>(_rhs), 
 				std::integral_constant<SizeT, (sizeof(Unsigned) * CHAR_BIT + ENTRY_SIZE - 1) / ENTRY_SIZE>());
@@ -1953,6 +2259,17 @@ namespace bignum{
 			return tmp;
 		}
 		
+		// the non-negative number of the digits x[0, n)
+		inline static BigInt fromDigits(const Ele *x, SizeT n){
+			BigInt res;
+			DigitBuffer _buf(&res.allocator, n);
+			res.constructZeroDigits(_buf);
+			std::copy(x, x + n, _buf.data);
+			res.takeDigits(_buf);
+			res.buf.shrinkToFit();
+			return res;
+		}
+		
 		// propagate_on_XXXX_assignment?
 		inline BigInt subStr(SizeT st, SizeT en) const &{
 			if((0 == en) || (en > buf.len)){
@@ -2009,8 +2326,8 @@ namespace bignum{
 					buf.data[i] = std::move(buf.data[i + st]);
 				}
 				
+				// the capacity stays the same, so the storage is kept
 				destroyAll(buf.data + (en - st), buf.data + buf.len, allocator);
-				allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
 				buf.setLen(en - st);
 				
 				return std::move(*this);
@@ -2036,6 +2353,8 @@ namespace bignum{
 				buf.data = std::move(tmp.data);
 				buf.len = tmp.len;
 				buf.cap = tmp.cap;
+				tmp.data = nullptr;
+				tmp.zeroLen();
 				
 				return std::move(*this);
 			}
@@ -2046,100 +2365,50 @@ namespace bignum{
 		void shl(Integer _rhs, std::false_type){
 			if(Integer(_rhs / ENTRY_SIZE) >= MAX_LEN){
 				std::ostringstream out;
-				out << "Cannot left shift a BigInt for more than " << ENTRY_SIZE * MAX_LEN << " bits";
+				out << "Cannot left shift a BigInt for more than " << std::uintmax_t(MAX_LEN) * ENTRY_SIZE << " bits";
 				throw std::domain_error(out.str());
 				// errno = EDOM;
 			}
 			
+			if(isZero()){
+				return ;
+			}
+			
 			SizeT padLen = static_cast<SizeT>(_rhs / ENTRY_SIZE);
 			LogSizeT shLen = static_cast<LogSizeT>(_rhs % ENTRY_SIZE);
-			Ele overflow = buf.data[buf.len - 1] >> (ENTRY_SIZE - shLen);
+			Ele overflow = (shLen == 0)? Ele(0): (buf.data[buf.len - 1] >> (ENTRY_SIZE - shLen));
 			
-			SizeT _len = buf.len + padLen +((overflow > 0)? 1: 0);
+			SizeT _len = buf.len + padLen + ((overflow > 0)? 1: 0);
 			bool exceed = _len > MAX_LEN;
 			if(exceed){
 				_len = MAX_LEN;
 			}
 			
-			DigitBuffer tmp = buf.realloc(_len);
-			if(nullptr == tmp){
-				// case for in-place reconstruction
-				
-				// exceeding
-				assert(!exceed || (_len == MAX_LEN));
-				
-				if((overflow > 0) && !exceed){
-					// overflow is considered eXpiring
-					allocator.construct(buf.data + buf.len + padLen, std::move(overflow));
-				}
-				
-				// note that since cap(len) == cap(_len), it holds that padLen == _len - len
-				// <= cap(_len) - len == cap(len) - len < 2* len - len == len, even if the
-				// result exceeds
-				SizeT i = exceed?(_len - 1): (buf.len + padLen - 1);
-				try{
-					for(;i >= buf.len;--i){
-						allocator.construct(buf.data + i, ((buf.data[i - padLen] << shLen) | (buf.data[i - padLen - 1] >> (ENTRY_SIZE - shLen))) & ((1 << ENTRY_SIZE) - 1));
-					}
-				}
-				catch(...){
-					destroyAll(buf.data + i - 1, buf.data + _len, allocator);
-					throw ;
-				}
-				for(i = buf.len - 1;i > padLen;--i){
-					buf.data[i] = ((buf.data[i - padLen] << shLen) | (buf.data[i - padLen - 1] >> (ENTRY_SIZE - shLen))) & ((1 << ENTRY_SIZE) - 1);
+			SizeT oldLen = buf.len;
+			buf.resize(_len);
+			
+			// move from the highest digit downwards, so that every source digit is
+			// read before being overwritten
+			for(SizeT i = _len;i > padLen;--i){
+				SizeT src = i - 1 - padLen;
+				Ele high = (src < oldLen)? buf.data[src]: Ele(0);
+				if(shLen == 0){
+					buf.data[i - 1] = high;
 				}
-				buf.data[padLen] = (buf.data[0] << shLen) & ((1 << ENTRY_SIZE) - 1);
-				for(i = 0; i < padLen;++i){
-					buf.data[i] = Ele(0);
+				else{
+					Ele low = ((src > 0) && (src - 1 < oldLen))? buf.data[src - 1]: Ele(0);
+					buf.data[i - 1] = (high << shLen) | (low >> (ENTRY_SIZE - shLen));
 				}
-				
-				buf.setLen(_len);
-				return ;
 			}
-			else{
-				// case for a realloc
-				assert(buf.cap < tmp.cap);
-				// exceeding
-				assert(!exceed || (tmp.len == MAX_LEN));
-				assert(!exceed || (tmp.cap == MAX_LEN));
-				
-				if((overflow > 0) && !exceed){
-					// overflow is considered eXpiring
-					allocator.construct(tmp.data + buf.len + padLen, std::move(overflow));
-				}
-				SizeT i = exceed? (tmp.len - 1): (buf.len + padLen - 1);
-				try{
-					for(;i > padLen;--i){
-						allocator.construct(tmp.data + i, ((buf.data[i - padLen] << shLen) | (buf.data[i - padLen - 1] >> (ENTRY_SIZE - shLen))) & ((1 << ENTRY_SIZE) - 1));
-					}
-					i = padLen;
-					allocator.construct(tmp.data + padLen, (buf.data[0] << shLen) & ((1 << ENTRY_SIZE) - 1));
-					if(i > 0){
-						for(--i;true;--i){
-							allocator.construct(tmp.data + i, Ele(0));
-							
-							if(i == 0){
-								break;
-							}
-						}
-					}
-				}
-				catch(...){
-					destroyAll(tmp.data + i + 1, tmp.data + tmp.len, allocator);
-					allocator.deallocate(tmp.data, tmp.cap);
-					tmp.data = nullptr;
-					throw ;
+			for(SizeT i(0);i < padLen;++i){
+				buf.data[i] = Ele(0);
+			}
+			
+			if(exceed){
+				buf.shrinkToFit();
+				if(buf.isZero()){
+					positive = true;
 				}
-				
-				destroyAll(buf.data, buf.data + buf.len, allocator);
-				allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-				buf.data = std::move(tmp.data);
-				buf.setLen(tmp.len);
-				tmp.data = nullptr;
-				tmp.zeroLen();
-				
-				return ;
 			}
 		}
 		// orignally designed for integer literals that are deduced to signed integer types
@@ -2162,86 +2431,36 @@ namespace bignum{
 		void shr(Integer _rhs, std::false_type){
 			if(Integer(_rhs / ENTRY_SIZE) >= MAX_LEN){
 				std::ostringstream out;
-				out << "Cannot right shift a BigInt for more than " << ENTRY_SIZE * MAX_LEN << " bits";
+				out << "Cannot right shift a BigInt for more than " << std::uintmax_t(MAX_LEN) * ENTRY_SIZE << " bits";
 				throw std::domain_error(out.str());
 				// errno = EDOM;
 			}
 			
-			SizeT padLen = _rhs / ENTRY_SIZE;
-			LogSizeT shLen = _rhs % ENTRY_SIZE;
-			Ele leftover = buf.data[buf.len - 1] >> shLen;
-			if((padLen + ((leftover > 0)? 0: 1)) >= buf.len){
+			SizeT padLen = static_cast<SizeT>(_rhs / ENTRY_SIZE);
+			LogSizeT shLen = static_cast<LogSizeT>(_rhs % ENTRY_SIZE);
+			if(padLen >= buf.len){
 				zerolize();
 				return ;
 			}
 			
-			SizeT _len = buf.len - padLen - ((leftover > 0)? 0: 1);
-			assert(buf.len > 0);
-			DigitBuffer tmp = buf.realloc(_len);
-			if(nullptr == tmp){
-				if((_len < 2) && (leftover > 0)){
-					// in-place reconstruction would only happen when original data
-					// has a length of 1
-					assert(1 == buf.cap);
-					assert(1 == buf.len);
-					
-					buf.data[0] = std::move(leftover);
-					return ;
+			SizeT _len = buf.len - padLen;
+			for(SizeT i(0);i < _len;++i){
+				Ele low = buf.data[i + padLen];
+				if(shLen == 0){
+					buf.data[i] = low;
 				}
 				else{
-					assert(buf.len >= (padLen + 1));
-					for(SizeT i(0);i < buf.len - padLen - 1;++i){
-						buf.data[i] = ((buf.data[i + padLen] >> shLen) | (buf.data[i + padLen + 1] << (ENTRY_SIZE - shLen))) & ((1 << ENTRY_SIZE) - 1);
-					}
-					
-					if(leftover > 0){
-						buf.data[buf.len - padLen - 1] = std::move(leftover);
-					}
+					Ele high = (i + 1 < _len)? buf.data[i + padLen + 1]: Ele(0);
+					buf.data[i] = (low >> shLen) | (high << (ENTRY_SIZE - shLen));
 				}
-				
-				destroyAll(buf.data + _len, buf.data + buf.len, allocator);
-				buf.len = _len;
-				return ;
 			}
-			else{
-				assert(_len == tmp.len);
-				
-				if((tmp.len < 2) && (leftover > 0)){
-					assert(1 == tmp.cap);
-					
-					allocator.construct(tmp.data + 0, std::move(leftover));
-				}
-				else{
-					assert(buf.len >= (padLen + 1));
-					SizeT i(0);
-					try{
-						for(;i < buf.len - padLen - 1;++i){
-							allocator.construct(tmp.data + i, ((buf.data[i + padLen] >> shLen) | (buf.data[i + padLen + 1] << (ENTRY_SIZE - shLen))) & ((1 << ENTRY_SIZE) - 1));
-						}
-						
-						assert(i == buf.len - padLen - 1);
-						if(leftover > 0){
-							allocator.construct(tmp.data + i, std::move(leftover));
-						}
-					}
-					catch(...){
-						destroyAll(tmp.data, tmp.data + i, allocator);
-						allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-						tmp.data = nullptr;
-						tmp.zeroLen();
-						throw ;
-					}
-				}
-				
-				destroyAll(buf.data, buf.data + buf.len, allocator);
-				allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-				
-				buf.data = std::move(tmp.data);
-				buf.len = tmp.len;
-				buf.cap = tmp.cap;
-				tmp.data = nullptr;
-				tmp.zeroLen();
-				return ;
+			buf.resize(_len);
+			
+			if((_len > 1) && (Ele(0) == buf.data[_len - 1])){
+				buf.shrinkToFit();
+			}
+			if(buf.isZero()){
+				positive = true;
 			}
 		}
 		// signed
@@ -2271,7 +2490,7 @@ namespace bignum{
 				return std::move(*this);
 			}
 			buf.resize(padLen + 1);
-			buf.data[padLen] &= (1 << leftLen) - 1;
+			buf.data[padLen] &= (Ele(1) << leftLen) - 1;
 			buf.shrinkToFit();
 			return std::move(*this);
 		}
@@ -2294,7 +2513,7 @@ namespace bignum{
 					res.allocator.construct(res.buf.data + i, buf.data[i]);
 				}
 				i = padLen;
-				res.allocator.construct(res.buf.data + i, buf.data[padLen] & ((1 << leftLen) - 1));
+				res.allocator.construct(res.buf.data + i, buf.data[padLen] & ((Ele(1) << leftLen) - 1));
 			}
 			catch(...){
 				destroyAll(res.buf.data, res.buf.data + i, res.allocator);
@@ -2309,12 +2528,7 @@ namespace bignum{
 		}*/
 		
 		inline SizeT lenOfBinary() const{
-			for(LogSizeT i = ENTRY_SIZE;i > 0;--i){
-				if((buf.data[buf.len - 1] & (1 << (i - 1))) != 0){
-					return (buf.len - 1) * ENTRY_SIZE + i;
-				}
-			}
-			assert(false);
+			return buf.len * ENTRY_SIZE - _utility::countLeadingZero(buf.data[buf.len - 1]);
 		}
 		
 		inline void add(const BigInt &_rhs){
@@ -2325,6 +2539,9 @@ namespace bignum{
 				else{
 					if(buf.compareRaw(_rhs.buf) >= 0){
 						buf.subRaw(_rhs.buf);
+						if(buf.isZero()){
+							positive = true;
+						}
 					}
 					else{
 						// hack
@@ -2346,6 +2563,9 @@ namespace bignum{
 				else{
 					if(buf.compareRaw(_rhs.buf) >= 0){
 						buf.subRaw(std::move(_rhs.buf));
+						if(buf.isZero()){
+							positive = true;
+						}
 					}
 					else{
 						// hack
@@ -2376,10 +2596,14 @@ namespace bignum{
 				else{
 					if(buf.compareRaw(_rhs.buf) >= 0){
 						buf.subRaw(_rhs.buf);
+						if(buf.isZero()){
+							positive = true;
+						}
 					}
 					else{
 						BigInt tmp = _rhs;
 						tmp.buf.subRaw(std::move(buf));
+						tmp.positive = !tmp.positive;
 						*this = std::move(tmp);
 					}
 				}
@@ -2396,10 +2620,14 @@ namespace bignum{
 				else{
 					if(buf.compareRaw(_rhs.buf) >= 0){
 						buf.subRaw(std::move(_rhs.buf));
+						if(buf.isZero()){
+							positive = true;
+						}
 					}
 					else{
 						BigInt tmp = std::move(_rhs);
 						tmp.buf.subRaw(std::move(buf));
+						tmp.positive = !tmp.positive;
 						*this = std::move(tmp);
 					}
 				}
@@ -2448,612 +2676,930 @@ namespace bignum{
 			positive = !positive;
 		}
 		
-		void selfMultiply(){
-			positive = true;
-			buf.resize(buf.cap << 1);
-			assert(buf.len == buf.cap);
-			
-			ModularP_T root = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len);
-			fft1DPower2(static_cast<std::size_t>(buf.len), root, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
-			});
-			
-			for(SizeT i = 0;i < buf.len;++i){
-				buf.data[i] = Ele(ModularP_T(buf.data[i]) * buf.data[i]);
+		// shorter operand length from which products leave the basecase
+		inline static SizeT basecaseThreshold() noexcept{
+			return _BIG_NUM_MUL_BASECASE_THRESHOLD_;
+		}
+		
+		// shorter operand length from which products go through NTT
+		inline static SizeT nttThreshold() noexcept{
+			return (_utility::simdLanes32() != 0)? SizeT(_BIG_NUM_MUL_NTT_THRESHOLD_): SizeT(_BIG_NUM_MUL_NTT_SCALAR_THRESHOLD_);
+		}
+		
+		inline static SizeT ceilPower2(SizeT n){
+			return static_cast<SizeT>(std::pow(2.0, std::ceil(std::log2(n))));
+		}
+		
+		// the i-th COEF_SIZE-bit coefficient of digits[0, len)
+		inline static Coef getCoef(const Ele *digits, SizeT len, SizeT i) noexcept{
+			SizeT idx = i / COEF_PER_ELE;
+			if(idx >= len){
+				return Coef(0);
+			}
+			return static_cast<Coef>((digits[idx] >> ((i % COEF_PER_ELE) * COEF_SIZE)) & ((Ele(1) << COEF_SIZE) - 1));
+		}
+		
+		// transforms digits[0, len) into N coefficients modulo the prime of Ring. Up to
+		// 2N coefficients are accepted, which are wrapped modulo x^N - 1. Spectra are
+		// only multiplied pointwise, so they are left in bit-reversed order.
+		template <class Ring>
+		inline static void transformDigits(CoefBuffer &res, const Ele *digits, SizeT len, SizeT N, Coef omega){
+			assert(len * COEF_PER_ELE <= 2 * N);
+			
+			res.resize(N);
+			const _utility::NTTPlan<Ring> &plan = _utility::NTTPlan<Ring>::get(N, Ring(omega), PRI_ORDER);
+			if(len * COEF_PER_ELE <= N){
+				plan.forwardDIF([digits, len](std::size_t i){
+					return getCoef(digits, len, static_cast<SizeT>(i));
+				}, res.data());
+			}
+			else{
+				plan.forwardDIF([digits, len, N](std::size_t i){
+					return Coef(Ring(getCoef(digits, len, static_cast<SizeT>(i))) + Ring(getCoef(digits, len, static_cast<SizeT>(i + N))));
+				}, res.data());
+			}
+		}
+		inline static void transformDigits(CoefBuffers &res, const Ele *digits, SizeT len, SizeT N){
+			transformDigits<ModularP1>(res.c1, digits, len, N, OMEGA1);
+			transformDigits<ModularP2>(res.c2, digits, len, N, OMEGA2);
+			transformDigits<ModularP3>(res.c3, digits, len, N, OMEGA3);
+		}
+		
+		// x ^ e for a power of 2 e
+		template <class Ring>
+		inline static Ring powPower2(Ring x, SizeT e){
+			for(;e > 1;e >>= 1){
+				x *= x;
 			}
+			return x;
+		}
+		
+		// res[j] = sum(coef(j + k * n) * c ^ k) for j < n, i.e. the polynomial with
+		// coefficients coef(0), ..., coef(len - 1) reduced modulo x ^ n - c
+		template <class Ring, typename Func>
+		inline static void foldCoefs(Coef *res, SizeT n, SizeT len, Ring c, Func &&coef){
+			typename Ring::Shoup cs(c);
 			
-			ModularP_T(invRoot) = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len * (buf.len - 1));
-			fft1DPower2(static_cast<std::size_t>(buf.len), invRoot, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
+			std::fill(res, res + n, Coef(0));
+			for(SizeT k = (len + n - 1) / n;k > 0;--k){
+				SizeT base = (k - 1) * n;
+				SizeT last = (len - base < n)? (len - base): n;
+				for(SizeT j(0);j < n;++j){
+					Coef x = (j < last)? Coef(Ring(coef(base + j))): Coef(0);
+					res[j] = Ring::lazyNormalize(Ring::lazyAdd(cs.mulLazy(res[j]), x));
+				}
+			}
+		}
+		
+		// transforms digits[0, len) reduced modulo x ^ T - zeta ^ T, zeta being the
+		// primitive 2N-th root of unity. Substituting x = zeta * z makes that modulus
+		// z ^ T - 1, so an ordinary T-point transform follows the twist by zeta ^ j.
+		template <class Ring>
+		inline static void transformTwisted(CoefBuffer &res, const Ele *digits, SizeT len, SizeT N, SizeT T, Coef omega){
+			Ring zeta = powPower2(Ring(omega), PRI_ORDER / (2 * N));
+			
+			res.resize(T);
+			foldCoefs(res.data(), T, len * COEF_PER_ELE, powPower2(zeta, T), [digits, len](SizeT i){
+				return getCoef(digits, len, i);
 			});
-			
-			ModularP_T inverseN = pow(ModularP_T(TWO_INV), std::round(std::log2(buf.len)));
-			for(SizeT i = 0;i < buf.len;++i){
-				buf.data[i] = static_cast<Ele>(buf.data[i] * inverseN);
+			Ring z(Coef(1));
+			for(SizeT j(0);j < T;++j){
+				res[j] = Coef(Ring(res[j]) * z);
+				z *= zeta;
 			}
-			
-			buf.propagateCarry();
-			buf.shrinkToFit();
+			_utility::NTTPlan<Ring>::get(T, Ring(omega), PRI_ORDER).forwardDIF(res.data());
+		}
+		inline static void transformTwisted(CoefBuffers &res, const Ele *digits, SizeT len, SizeT N, SizeT T){
+			transformTwisted<ModularP1>(res.c1, digits, len, N, T, OMEGA1);
+			transformTwisted<ModularP2>(res.c2, digits, len, N, T, OMEGA2);
+			transformTwisted<ModularP3>(res.c3, digits, len, N, T, OMEGA3);
 		}
 		
-		void multiplyMedium(const BigInt &_rhs){
-			positive = (positive == _rhs.positive);
-			
-			DigitBuffer tmp(&allocator, nullptr);
-			tmp.cap = static_cast<SizeT>(std::pow(2.0, std::ceil(std::log2(buf.len + _rhs.buf.len))));
-			tmp.len = tmp.cap;
-			tmp.data = allocator.allocate(static_cast<std::size_t>(tmp.cap));
+		// inverse of transformTwisted, leaving the product modulo x ^ T - zeta ^ T
+		template <class Ring>
+		inline static void inverseTwisted(CoefBuffer &coefs, SizeT N, Coef omega){
+			SizeT T = static_cast<SizeT>(coefs.size());
+			_utility::NTTPlan<Ring>::get(T, Ring(omega), PRI_ORDER).inverseDIT(coefs.data());
+			
+			// zeta ^ {-1} = zeta ^ {2N - 1}
+			Ring zeta = powPower2(Ring(omega), PRI_ORDER / (2 * N));
+			Ring zetaInv(Coef(1));
+			for(SizeT n(1);n < 2 * N;n <<= 1){
+				zetaInv *= zeta;
+				zeta *= zeta;
+			}
+			Ring z(Coef(1));
+			for(SizeT j(0);j < T;++j){
+				coefs[j] = Coef(Ring(coefs[j]) * z);
+				z *= zetaInv;
+			}
+		}
+		inline static void inverseTwisted(CoefBuffers &coefs, SizeT N){
+			inverseTwisted<ModularP1>(coefs.c1, N, OMEGA1);
+			inverseTwisted<ModularP2>(coefs.c2, N, OMEGA2);
+			inverseTwisted<ModularP3>(coefs.c3, N, OMEGA3);
+		}
+		
+		// combines the product modulo x ^ N - 1 in cyc with the one modulo
+		// x ^ T - zeta ^ T in tail into the product modulo both, of N + T coefficients.
+		// As x ^ N = -1 modulo the latter, the product is cyc + (x ^ N - 1) * h with
+		// h = (cyc - tail) / 2 there.
+		template <class Ring>
+		inline static void mergeTwisted(CoefBuffer &cyc, const CoefBuffer &tail, Coef omega, Coef p){
+			SizeT N = static_cast<SizeT>(cyc.size());
+			SizeT T = static_cast<SizeT>(tail.size());
+			Ring c = powPower2(powPower2(Ring(omega), PRI_ORDER / (2 * N)), T);
+			Ring half(Coef((p >> 1) + 1));
+			
+			CoefBuffer h(T, Coef(0), cyc.get_allocator());
+			foldCoefs(h.data(), T, N, c, [&cyc](SizeT i){
+				return cyc[i];
+			});
+			cyc.resize(N + T);
+			for(SizeT j(0);j < T;++j){
+				Ring hj = (Ring(h[j]) - Ring(tail[j])) * half;
+				cyc[j] = Coef(Ring(cyc[j]) - hj);
+				cyc[N + j] = Coef(hj);
+			}
+		}
+		inline static void mergeTwisted(CoefBuffers &cyc, const CoefBuffers &tail){
+			mergeTwisted<ModularP1>(cyc.c1, tail.c1, OMEGA1, P1);
+			mergeTwisted<ModularP2>(cyc.c2, tail.c2, OMEGA2, P2);
+			mergeTwisted<ModularP3>(cyc.c3, tail.c3, OMEGA3, P3);
+		}
+		
+		// inverse transform of a bit-reversed spectrum, including the multiplication of
+		// N^{-1}
+		template <class Ring>
+		inline static void inverseTransform(CoefBuffer &coefs, Coef omega){
+			SizeT N = static_cast<SizeT>(coefs.size());
 			
-#ifdef _BIG_NUM_DEBUG_
-			SizeT _len1 = buf.len;
-			SizeT _len2 = _rhs.buf.len;
-#endif // _BIG_NUM_DEBUG_
+			_utility::NTTPlan<Ring>::get(N, Ring(omega), PRI_ORDER).inverseDIT(coefs.data());
+		}
+		inline static void inverseTransform(CoefBuffers &coefs){
+			inverseTransform<ModularP1>(coefs.c1, OMEGA1);
+			inverseTransform<ModularP2>(coefs.c2, OMEGA2);
+			inverseTransform<ModularP3>(coefs.c3, OMEGA3);
+		}
+		
+		template <class Ring>
+		inline static void pointwiseMultiply(CoefBuffer &_lhs, const CoefBuffer &_rhs){
+			assert(_lhs.size() == _rhs.size());
 			
+			_utility::NTTPlan<Ring>::multiplyPointwise(_lhs.data(), _rhs.data(), _lhs.size());
+		}
+		inline static void pointwiseMultiply(CoefBuffers &_lhs, const CoefBuffers &_rhs){
+			pointwiseMultiply<ModularP1>(_lhs.c1, _rhs.c1);
+			pointwiseMultiply<ModularP2>(_lhs.c2, _rhs.c2);
+			pointwiseMultiply<ModularP3>(_lhs.c3, _rhs.c3);
+		}
+		
+		// recombines the residues of the i-th coefficient with Garner's algorithm.
+		// Returns the low 64 bits of the result and stores the rest in high.
+		inline static std::uint64_t crtCoef(const CoefBuffers &coefs, SizeT i, std::uint64_t &high) noexcept{
+			Coef r1 = coefs.c1[i];
+			
+			// x12 = r1 + P1 * t2 < P1 * P2
+			Coef t2 = Coef((ModularP2(coefs.c2[i]) - ModularP2(r1)) * P1_INV_P2);
+			std::uint64_t x12 = std::uint64_t(r1) + std::uint64_t(P1) * t2;
+			
+			// x = x12 + P1 * P2 * t3 < P1 * P2 * P3
+			Coef t3 = Coef((ModularP3(coefs.c3[i]) - ModularP3(Coef(x12 % P3))) * P1P2_INV_P3);
+			std::uint64_t low = _utility::mulFull(std::uint64_t(P1) * P2, std::uint64_t(t3), high);
+			low += x12;
+			high += static_cast<std::uint64_t>(low < x12);
+			return low;
+		}
+		
+		// digits[0, len) += sum(coefs[i] * 2^{i * COEF_SIZE}), assuming the sum fits in
+		// len digits
+		inline static void addCoefs(Ele *digits, SizeT len, const CoefBuffers &coefs, SizeT coefLen){
+			using Acc = std::uint64_t;
+			constexpr int ACC_SIZE = std::numeric_limits<Acc>::digits;
+			
+			// value waiting to be added at the bit offset of the current coefficient,
+			// which is accLow + accHigh * 2^{ACC_SIZE}
+			Acc accLow(0), accHigh(0);
+			Ele carry(0);
 			SizeT i(0);
-			try{
-				for(;i < _rhs.buf.len;++i){
-					allocator.construct(tmp.data + i, _rhs.buf.data[i]);
+			for(SizeT d(0);d < len;++d){
+				if((i >= coefLen) && (Acc(0) == accLow) && (Acc(0) == accHigh) && (Ele(0) == carry)){
+					break;
 				}
-				for(i = _rhs.buf.len;i < tmp.len;++i){
-					allocator.construct(tmp.data + i, Ele(0));
+				
+				Ele word(0);
+				for(SizeT k(0);k < COEF_PER_ELE;++k, ++i){
+					if(i < coefLen){
+						Acc high;
+						Acc low = crtCoef(coefs, i, high);
+						accLow += low;
+						accHigh += high + static_cast<Acc>(accLow < low);
+					}
+					word |= static_cast<Ele>(static_cast<Ele>(accLow & ((Acc(1) << COEF_SIZE) - 1)) << (k * COEF_SIZE));
+					accLow = (accLow >> COEF_SIZE) | (accHigh << (ACC_SIZE - COEF_SIZE));
+					accHigh >>= COEF_SIZE;
 				}
+				digits[d] = _utility::addWithCarry(digits[d], word, carry);
 			}
-			catch(...){
-				destroyAll(tmp.data, tmp.data + i, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
-				throw ;
+			assert((Acc(0) == accLow) && (Acc(0) == accHigh) && (Ele(0) == carry));
+		}
+		
+		// res[0, resLen) += _lhs[0, lLen) * _rhs[0, rLen) via one NTT convolution, where
+		// the product has to fit in a single transform. Squaring is detected so that
+		// only one forward transform is needed.
+		// 
+		// Instead of padding a product just longer than a power of 2 to the next one,
+		// it is computed modulo x ^ N - 1 and modulo x ^ T - zeta ^ T by an N-point and
+		// a smaller T-point transform, with T the power of 2 covering the rest.
+		// 
+		// The transforms of _rhs are taken from rCache when it is given.
+		inline void multiplyDigitsNTT(Ele *res, SizeT resLen, const Ele *_lhs, SizeT lLen, const Ele *_rhs, SizeT rLen, 
+			TransformCache *rCache = nullptr){
+			assert(lLen + rLen <= PRI_ORDER / COEF_PER_ELE);
+			assert(lLen + rLen <= resLen);
+			
+			constexpr SizeT MIN_TAIL = 64;
+			
+			SizeT coefLen = (lLen + rLen) * COEF_PER_ELE;
+			SizeT N = ceilPower2(coefLen);
+			SizeT T(0);
+			{
+				// with the folding of the operands, a tail of half the transform no longer
+				// pays off
+				SizeT tail = ceilPower2(std::max(coefLen - N / 2, MIN_TAIL));
+				if(tail <= N / 8){
+					N /= 2;
+					T = tail;
+				}
 			}
 			
-			buf.resize(tmp.len);
-			assert(buf.len == tmp.len);
-			assert(tmp.len == tmp.cap);
-			
-			ModularP_T root = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len);
-			fft1DPower2(static_cast<std::size_t>(buf.len), root, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
-			});
-			fft1DPower2(static_cast<std::size_t>(tmp.len), root, [&tmp](std::size_t i){
-				return tmp.data[static_cast<SizeT>(i)];
-			}, [&tmp](std::size_t i) -> Ele &{
-				return tmp.data[static_cast<SizeT>(i)];
-			});
-			
-			for(SizeT i(0);i < buf.len;++i){
-				buf.data[i] = Ele(ModularP_T(buf.data[i]) * ModularP_T(tmp.data[i]));
+			CoefBuffers lCoefs(allocator), lTail(allocator);
+			if((_lhs == _rhs) && (lLen == rLen)){
+				transformDigits(lCoefs, _lhs, lLen, N);
+				pointwiseMultiply(lCoefs, lCoefs);
+				if(0 != T){
+					transformTwisted(lTail, _lhs, lLen, N, T);
+					pointwiseMultiply(lTail, lTail);
+				}
 			}
-			
-			ModularP_T invRoot = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len * (buf.len - 1));
-			fft1DPower2(static_cast<std::size_t>(buf.len), invRoot, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
-			});
-			
-			ModularP_T inverseN = pow(ModularP_T(TWO_INV), std::round(std::log2(buf.len)));
-			//ModularP_T inverseN = ModularP_T(ModularP_T(static_cast<Ele>(buf.len))).inverse();
-			for(SizeT i(0);i < buf.len;++i){
-				buf.data[i] = Ele(buf.data[i] * inverseN);
+			else if(nullptr != rCache){
+				const typename TransformCache::Entry &r = cachedTransform(*rCache, _rhs, rLen, N, T);
+				transformDigits(lCoefs, _lhs, lLen, N);
+				pointwiseMultiply(lCoefs, r.coefs);
+				if(0 != T){
+					transformTwisted(lTail, _lhs, lLen, N, T);
+					pointwiseMultiply(lTail, r.tail);
+				}
 			}
-			
-#ifdef _BIG_NUM_DEBUG_
-			assert(((_len1 + _len2) == buf.cap) || (buf.data[_len1 + _len2]== Ele(0)));
-#endif // _BIG_NUM_DEBUG_
-			
-			destroyAll(tmp.data, tmp.data + tmp.len, allocator);
-			allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-			tmp.data = nullptr;
-			tmp.zeroLen();
-			
-			buf.propagateCarry();
-			buf.shrinkToFit();
-		}
-		void multiplyMedium(BigInt &&_rhs){
-			positive = (positive == _rhs.positive);
-			
-			_rhs.buf.resize(static_cast<SizeT>(std::pow(2.0, std::ceil(std::log2(buf.len + _rhs.buf.len)))));
-			assert(_rhs.buf.len == _rhs.buf.cap);
-			buf.resize(_rhs.buf.len);
-			assert(buf.len == _rhs.buf.len);
-			
-			ModularP_T root = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len);
-			fft1DPower2(static_cast<std::size_t>(buf.len), root, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
-			});
-			fft1DPower2(static_cast<std::size_t>(_rhs.buf.len), root, [&_rhs](std::size_t i){
-				return _rhs.buf.data[static_cast<SizeT>(i)];
-			}, [&_rhs](std::size_t i) -> Ele &{
-				return _rhs.buf.data[static_cast<SizeT>(i)];
-			});
-			
-			for(SizeT i(0);i < buf.len;++i){
-				buf.data[i] = Ele(ModularP_T(buf.data[i]) * ModularP_T(_rhs.buf.data[i]));
+			else{
+				// both transforms are large enough to be worth separate threads
+				CoefBuffers rCoefs(allocator);
+				_utility::parallelInvoke((N >= _BIG_NUM_NTT_PARALLEL_THRESHOLD_) && (_utility::getThreadCount() > 1), [&](){
+					transformDigits(lCoefs, _lhs, lLen, N);
+				}, [&](){
+					transformDigits(rCoefs, _rhs, rLen, N);
+				});
+				pointwiseMultiply(lCoefs, rCoefs);
+				if(0 != T){
+					CoefBuffers rTail(allocator);
+					transformTwisted(lTail, _lhs, lLen, N, T);
+					transformTwisted(rTail, _rhs, rLen, N, T);
+					pointwiseMultiply(lTail, rTail);
+				}
 			}
-			
-			ModularP_T invRoot = pow(ModularP_T(OMEGA), PRI_ORDER / buf.len * (buf.len - 1));
-			fft1DPower2(static_cast<std::size_t>(buf.len), invRoot, [this](std::size_t i){
-				return buf.data[static_cast<SizeT>(i)];
-			}, [this](std::size_t i) -> Ele &{
-				return buf.data[static_cast<SizeT>(i)];
-			});
-			
-			ModularP_T inverseN = pow(ModularP_T(TWO_INV), std::round(std::log2(buf.len)));
-			for(SizeT i(0);i < buf.len;++i){
-				buf.data[i] = Ele(buf.data[i] * inverseN);
+			inverseTransform(lCoefs);
+			if(0 != T){
+				inverseTwisted(lTail, N);
+				mergeTwisted(lCoefs, lTail);
 			}
 			
-			buf.propagateCarry();
-			buf.shrinkToFit();
+			addCoefs(res, resLen, lCoefs, coefLen);
 		}
 		
-		// originally designed for small value _rhs converted from integers, 
-		// however, it might be used in other situations
-		void multiplySmall(BigInt &&_rhs){
-			positive = (positive == _rhs.positive);
-			
-			SizeT _len = buf.len + _rhs.buf.len - 1;
-			if(_len > MAX_LEN){
-				throw std::out_of_range("BigInt::mutiplySmall");
-				// errno = ERANGE;
+		// the transforms of digits[0, len) for an N-point product with a T-point tail,
+		// computed on first use
+		inline const typename TransformCache::Entry &cachedTransform(TransformCache &cache, const Ele *digits, SizeT len, SizeT N, SizeT T){
+			auto key = std::make_tuple(digits, len, N, T);
+			auto it = cache.entries.find(key);
+			if(cache.entries.end() == it){
+				typename TransformCache::Entry entry(allocator);
+				transformDigits(entry.coefs, digits, len, N);
+				if(0 != T){
+					transformTwisted(entry.tail, digits, len, N, T);
+				}
+				it = cache.entries.emplace(key, std::move(entry)).first;
+			}
+			return it->second;
+		}
+		
+		// res[0, resLen) += _lhs[0, lLen) * _rhs[0, rLen). Operands too long for a
+		// single transform are cut into blocks, and the block products are added at
+		// their digit offsets.
+		inline void multiplyDigits(Ele *res, SizeT resLen, const Ele *_lhs, SizeT lLen, const Ele *_rhs, SizeT rLen, 
+			TransformCache *rCache = nullptr){
+			if(lLen + rLen <= PRI_ORDER / COEF_PER_ELE){
+				multiplyDigitsNTT(res, resLen, _lhs, lLen, _rhs, rLen, rCache);
+				return ;
 			}
 			
-			// caculate the best spiling size LogSizeT
-			long double _tmin = std::numeric_limits<long double>::max();
-			SizeT N;
-			SizeT _N = (_rhs.buf.cap == _rhs.buf.len)? (_rhs.buf.cap << 1): _rhs.buf.cap;
-			// smallest power of 2 greater than _rhs.len: _rhs.cap;
-			for(;_N <= _len;_N <<= 1){
-				// ceil(buf.len / (_N - _rhs.buf.len + 1))
-				long double cost = (buf.len + _N - _rhs.buf.len) / (_N + 1 - _rhs.buf.len) * std::log2(_N + 1) * _N;
-				if(_tmin > cost){
-					_tmin = cost;
-					N = _N;
+			constexpr SizeT B = PRI_ORDER / COEF_PER_ELE / 2;
+			for(SizeT i(0);i < lLen;i += B){
+				SizeT li = (lLen - i < B)? (lLen - i): B;
+				for(SizeT j(0);j < rLen;j += B){
+					SizeT rj = (rLen - j < B)? (rLen - j): B;
+					multiplyDigitsNTT(res + (i + j), resLen - (i + j), _lhs + i, li, _rhs + j, rj, rCache);
 				}
 			}
-			SizeT L = N - _rhs.buf.len + 1;
-			//assert((buf.len + L - 1) / L > 1);
-			
-			SizeT _repe = buf.len / L;
-			SizeT _left = buf.len % L;
-			
-			ModularP_T root = pow(ModularP_T(OMEGA), PRI_ORDER / N);
-			ModularP_T invRoot = pow(ModularP_T(OMEGA), PRI_ORDER / N * (N - 1));
-			ModularP_T inverseN = pow(ModularP_T(TWO_INV), std::round(std::log2(N)));
-			
-			_rhs.buf.resize(N);
-			fft1DPower2(static_cast<std::size_t>(N), root, [&_rhs](std::size_t i){
-				return _rhs.buf.data[static_cast<SizeT>(i)];
-			}, [&_rhs](std::size_t i) -> Ele &{
-				return _rhs.buf.data[static_cast<SizeT>(i)];
-			});
-			
-			DigitBuffer tmp(&allocator, nullptr);
-			tmp.len = N;
-			tmp.cap = N;
-			tmp.data = allocator.allocate(static_cast<std::size_t>(tmp.cap));
-			SizeT i = 0;
+		}
+		
+		// constructs _buf.len zero digits in a freshly allocated _buf
+		inline void constructZeroDigits(DigitBuffer &_buf){
+			SizeT i(0);
 			try{
-				for(;i < tmp.len;++i){
-					allocator.construct(tmp.data + i, 0);
+				for(;i < _buf.len;++i){
+					allocator.construct(_buf.data + i, Ele(0));
 				}
 			}
 			catch(...){
-				destroyAll(tmp.data, tmp.data + i, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
+				destroyAll(_buf.data, _buf.data + i, allocator);
+				allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
+				_buf.data = nullptr;
+				_buf.zeroLen();
 				
-				throw;
+				throw ;
 			}
-			_BIG_NUM_ADD_FINALIZER_CODE_(
-				destroyAll(tmp.data, tmp.data + tmp.len, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
-			);
-			
-			// since _repe > 0
-			// nL ... nL + L - 1
-			fft1DPower2(static_cast<std::size_t>(N), root, [this, &L](std::size_t i){
-				if(static_cast<SizeT>(i) < L){
-					return buf.data[static_cast<SizeT>(i)];
-				}
-				else{
-					return Ele(0);
-				}
-			}, [&tmp, this](std::size_t i) -> Ele&{
-				return tmp.data[static_cast<SizeT>(i)];
-			});
+		}
+		
+		// replaces digits of this with those in _buf, which is emptied
+		inline void takeDigits(DigitBuffer &_buf){
+			destroyAll(buf.data, buf.data + buf.len, allocator);
+			allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
+			buf.data = _buf.data;
+			buf.len = _buf.len;
+			buf.cap = _buf.cap;
+			_buf.data = nullptr;
+			_buf.zeroLen();
+		}
+		
+		inline void releaseDigits(DigitBuffer &_buf){
+			destroyAll(_buf.data, _buf.data + _buf.len, allocator);
+			allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
+			_buf.data = nullptr;
+			_buf.zeroLen();
+		}
+		
+		// this = this ^ 2, using the squaring variant of whichever tier the length
+		// falls in
+		void selfMultiply(){
+			positive = true;
 			
-			for(SizeT i(0);i < N;++i){
-				tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(_rhs.buf.data[i]));
+			SizeT _len = buf.len * 2;
+			if(_len > MAX_LEN){
+				throw std::out_of_range("BigInt::selfMultiply");
+				// errno = ERANGE;
 			}
-			fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-				return tmp.data[static_cast<SizeT>(i)];
-			}, [&tmp](std::size_t i) -> Ele &{
-				return tmp.data[static_cast<SizeT>(i)];
-			});
 			
 			DigitBuffer _buf(&allocator, _len);
-			i = 0;
+			constructZeroDigits(_buf);
 			try{
-				for(;i < N;++i){
-					allocator.construct(_buf.data + i, Ele(tmp.data[i] * inverseN));
-				}
+				squareDigitsFull(_buf.data, buf.data, buf.len);
 			}
 			catch(...){
-				destroyAll(_buf.data, _buf.data + i, allocator);
-				allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-				_buf.data = nullptr;
-				_buf.zeroLen();
-				
+				releaseDigits(_buf);
 				throw ;
 			}
 			
-			for(SizeT k(1);k < _repe;++k){
-				fft1DPower2(static_cast<std::size_t>(N), root, [this, &L, &k](std::size_t i){
-					if(static_cast<SizeT>(i) < L){
-						return buf.data[k * L + static_cast<SizeT>(i)];
-					}
-					else{
-						return Ele(0);
-					}
-				}, [&tmp](std::size_t i) -> Ele&{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N;++i){
-					tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(_rhs.buf.data[i]));
-				}
-				fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-					return tmp.data[static_cast<SizeT>(i)];
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				
-				for(SizeT i(0);i < N - L;++i){
-					_buf.data[k * L + i] += Ele(tmp.data[i] * inverseN);
-				}
-				SizeT i = N - L;
-				try{
-					for(;i < N;++i){
-						allocator.construct(_buf.data + k * L + i, Ele(tmp.data[i] * inverseN));
-					}
-				}
-				catch(...){
-					destroyAll(_buf.data, _buf.data + k * L + i, allocator);
-					allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-					_buf.data = nullptr;
-					_buf.zeroLen();
-					
-					throw ;
-				}
-			}
+			takeDigits(_buf);
+			buf.shrinkToFit();
+		}
+		
+		void multiplyMedium(const BigInt &_rhs, TransformCache *rCache = nullptr){
+			bool _positive = (positive == _rhs.positive);
 			
-			if(_left > 0){
-				fft1DPower2(static_cast<std::size_t>(N), root, [this, &_left, &_repe, &L](std::size_t i){
-					if(static_cast<std::size_t>(i) < _left){
-						return buf.data[_repe * L + static_cast<SizeT>(i)];
-					}
-					else{
-						return Ele(0);
-					}
-				}, [&tmp](std::size_t i) -> Ele&{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N;++i){
-					tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(_rhs.buf.data[i]));
-				}
-				fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-					return tmp.data[static_cast<SizeT>(i)];
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N - L;++i){
-					_buf.data[_repe * L + i] += Ele(tmp.data[i] * inverseN);
-				}
-				i = N - L;
-				try{
-					assert(_repe * L + N >= _len);
-					// the rest are discarded since they are sure to be zero.
-					for(;i < _len - _repe * L;++i){
-						allocator.construct(_buf.data + _repe * L + i, Ele(tmp.data[i] * inverseN));
-					}
-				}
-				catch(...){
-					destroyAll(_buf.data, _buf.data + _repe * L + i, allocator);
-					allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-					_buf.data = nullptr;
-					_buf.zeroLen();
-					
-					throw ;
-				}
+			SizeT _len = buf.len + _rhs.buf.len;
+			if(_len > MAX_LEN){
+				throw std::out_of_range("BigInt::multiplyMedium");
+				// errno = ERANGE;
 			}
 			
-			_buf.propagateCarry();
-			_buf.shrinkToFit();
-			
-			destroyAll(buf.data, buf.data + buf.len, allocator);
-			allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-			buf.data = _buf.data;
-			buf.len = _buf.len;
-			buf.cap = _buf.cap;
-			_buf.data = nullptr;
-			_buf.zeroLen();
+			DigitBuffer _buf(&allocator, _len);
+			constructZeroDigits(_buf);
+			try{
+				multiplyDigits(_buf.data, _len, buf.data, buf.len, _rhs.buf.data, _rhs.buf.len, rCache);
+			}
+			catch(...){
+				releaseDigits(_buf);
+				throw ;
+			}
 			
-			return ;
+			takeDigits(_buf);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
 		}
-		void multiplySmall(const BigInt &_rhs){
-			positive = (positive == _rhs.positive);
+		void multiplyMedium(BigInt &&_rhs){
+			multiplyMedium(static_cast<const BigInt &>(_rhs));
+		}
+		
+		// originally designed for small value _rhs converted from integers, 
+		// however, it might be used in other situations. The transform of _rhs is
+		// taken from rCache when it is given.
+		void multiplySmall(const BigInt &_rhs, TransformCache *rCache = nullptr){
+			bool _positive = (positive == _rhs.positive);
 			
-			SizeT _len = buf.len + _rhs.buf.len - 1;
+			SizeT _len = buf.len + _rhs.buf.len;
 			if(_len > MAX_LEN){
 				throw std::out_of_range("BigInt::mutiplySmall");
 				// errno = ERANGE;
 			}
 			
+			// caculate the best spiling size. blocks of this are cut at digit
+			// boundaries, so that block products can be added at digit offsets.
+			SizeT rCoef = _rhs.buf.len * COEF_PER_ELE;
+			SizeT lCoef = buf.len * COEF_PER_ELE;
+			if(rCoef + COEF_PER_ELE > PRI_ORDER){
+				// no block of this fits in a single transform along with _rhs
+				multiplyMedium(_rhs, rCache);
+				return ;
+			}
 			long double _tmin = std::numeric_limits<long double>::max();
-			SizeT N;
-			SizeT _N = (_rhs.buf.cap == _rhs.buf.len)? (_rhs.buf.cap << 1): _rhs.buf.cap;
-			for(;_N <= _len;_N <<= 1){
-				long double cost = (buf.len + _N - _rhs.buf.len) / (_N + 1 - _rhs.buf.len) * std::log2(_N + 1) * _N;
+			SizeT N(0), L(0);
+			for(SizeT _N = ceilPower2(rCoef + COEF_PER_ELE);((_N >> 1) < lCoef + rCoef) && (_N <= PRI_ORDER);_N <<= 1){
+				// digits of this per block
+				SizeT _L = (_N - rCoef + 1) / COEF_PER_ELE;
+				long double cost = static_cast<long double>((buf.len + _L - 1) / _L) * std::log2(_N) * _N;
 				if(_tmin > cost){
 					_tmin = cost;
 					N = _N;
+					L = _L;
 				}
 			}
-			SizeT L = N - _rhs.buf.len + 1;
-			//assert((buf.len + L - 1) / L > 1);
-			
-			SizeT _repe = buf.len / L;
-			SizeT _left = buf.len % L;
+			assert(L > 0);
 			
-			ModularP_T root = pow(ModularP_T(OMEGA), PRI_ORDER / N);
-			ModularP_T invRoot = pow(ModularP_T(OMEGA), PRI_ORDER / N * (N - 1));
-			ModularP_T inverseN = pow(ModularP_T(TWO_INV), std::round(std::log2(N)));
-			
-			DigitBuffer rBuf(&allocator, nullptr);
-			rBuf.cap = N;
-			rBuf.len = N;
-			rBuf.data = allocator.allocate(static_cast<std::size_t>(rBuf.cap));
-			// TODO: change functors to iterators
-			SizeT i = 0;
-			try{
-				for(;i < rBuf.len;++i){
-					allocator.construct(rBuf.data + i, 0);
-				}
+			CoefBuffers rOwn(allocator);
+			const CoefBuffers *rCoefs = &rOwn;
+			if(nullptr != rCache){
+				rCoefs = &cachedTransform(*rCache, _rhs.buf.data, _rhs.buf.len, N, 0).coefs;
+			}
+			else{
+				transformDigits(rOwn, _rhs.buf.data, _rhs.buf.len, N);
 			}
-			catch(...){
-				destroyAll(rBuf.data, rBuf.data + i, allocator);
-				allocator.deallocate(rBuf.data, static_cast<std::size_t>(rBuf.cap));
-				rBuf.data = nullptr;
-				rBuf.zeroLen();
-				
-				throw;
-			}
-			_BIG_NUM_ADD_FINALIZER_CODE_(
-				destroyAll(rBuf.data, rBuf.data + rBuf.len, allocator);
-				allocator.deallocate(rBuf.data, static_cast<std::size_t>(rBuf.cap));
-				rBuf.data = nullptr;
-				rBuf.zeroLen();
-			);
-			
-			fft1DPower2(static_cast<std::size_t>(N), root, [&_rhs](std::size_t i){
-				if(i < _rhs.buf.len){
-					return _rhs.buf.data[static_cast<SizeT>(i)];
-				}else{
-					return Ele(0);
-				}
-			}, [&rBuf, this](std::size_t i) -> Ele &{
-				return rBuf.data[static_cast<SizeT>(i)];
-			});
 			
-			DigitBuffer tmp(&allocator, nullptr);
-			tmp.len = N;
-			tmp.cap = N;
-			tmp.data = allocator.allocate(static_cast<std::size_t>(tmp.cap));
-			i = 0;
+			DigitBuffer _buf(&allocator, _len);
+			constructZeroDigits(_buf);
 			try{
-				for(;i < tmp.len;++i){
-					allocator.construct(tmp.data + i, 0);
+				CoefBuffers tmp(allocator);
+				// nL ... nL + L - 1
+				for(SizeT st(0);st < buf.len;st += L){
+					SizeT bLen = (buf.len - st < L)? (buf.len - st): L;
+					transformDigits(tmp, buf.data + st, bLen, N);
+					pointwiseMultiply(tmp, *rCoefs);
+					inverseTransform(tmp);
+					addCoefs(_buf.data + st, _len - st, tmp, bLen * COEF_PER_ELE + rCoef - 1);
 				}
 			}
 			catch(...){
-				destroyAll(tmp.data, tmp.data + i, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
-				
-				throw;
+				releaseDigits(_buf);
+				throw ;
 			}
-			_BIG_NUM_ADD_FINALIZER_CODE_(
-				destroyAll(tmp.data, tmp.data + tmp.len, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
-			);
 			
-			// since _repe > 0
-			// nL ... nL + L - 1
-			fft1DPower2(static_cast<std::size_t>(N), root, [this, &L](std::size_t i){
-				if(static_cast<SizeT>(i) < L){
-					return buf.data[static_cast<SizeT>(i)];
-				}
-				else{
-					return Ele(0);
-				}
-			}, [&tmp, this](std::size_t i) -> Ele &{
-				return tmp.data[static_cast<SizeT>(i)];
-			});
+			takeDigits(_buf);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
+		}
+		void multiplySmall(BigInt &&_rhs){
+			multiplySmall(static_cast<const BigInt &>(_rhs));
+		}
+		
+		// quadratic multiplication for operands too short to benefit from a transform
+		void multiplyBasecase(const BigInt &_rhs){
+			bool _positive = (positive == _rhs.positive);
 			
-			for(SizeT i(0);i < N;++i){
-				tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(rBuf.data[i]));
+			SizeT _len = buf.len + _rhs.buf.len;
+			if(_len > MAX_LEN){
+				throw std::out_of_range("BigInt::multiplyBasecase");
+				// errno = ERANGE;
 			}
-			fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-				return tmp.data[static_cast<SizeT>(i)];
-			}, [&tmp](std::size_t i) -> Ele &{
-				return tmp.data[static_cast<SizeT>(i)];
-			});
 			
 			DigitBuffer _buf(&allocator, _len);
-			i = 0;
-			try{
-				for(;i < N;++i){
-					allocator.construct(_buf.data + i, Ele(tmp.data[i] * inverseN));
-				}
-			}
-			catch(...){
-				destroyAll(_buf.data, _buf.data + i, allocator);
-				allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-				_buf.data = nullptr;
-				_buf.zeroLen();
-				
-				throw ;
+			constructZeroDigits(_buf);
+			_utility::mulDigits(_buf.data, buf.data, buf.len, _rhs.buf.data, _rhs.buf.len);
+			
+			takeDigits(_buf);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
+		}
+		
+		// res[0, lLen + rLen) = _lhs[0, lLen) * _rhs[0, rLen) by Karatsuba's method,
+		// assuming lLen >= rLen. _lhs is cut into rLen-digit blocks so that every
+		// block product is balanced.
+		inline void multiplyDigitsKaratsuba(Ele *res, const Ele *_lhs, SizeT lLen, const Ele *_rhs, SizeT rLen){
+			assert(lLen >= rLen);
+			
+			if(rLen < _BIG_NUM_MUL_BASECASE_THRESHOLD_){
+				_utility::mulDigits(res, _lhs, lLen, _rhs, rLen);
+				return ;
 			}
 			
-			for(SizeT k(1);k < _repe;++k){
-				fft1DPower2(static_cast<std::size_t>(N), root, [this, &L, &k](std::size_t i){
-					if(static_cast<SizeT>(i) < L){
-						return buf.data[k * L + static_cast<SizeT>(i)];
-					}
-					else{
-						return Ele(0);
-					}
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N;++i){
-					tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(rBuf.data[i]));
+			SizeT threshold = _BIG_NUM_MUL_BASECASE_THRESHOLD_;
+			EleBuffer tmp(2 * rLen + _utility::karatsubaScratchLen(rLen, threshold), Ele(0), allocator);
+			Ele *prod = tmp.data(), *scratch = tmp.data() + 2 * rLen;
+			for(SizeT st(0);st < lLen;st += rLen){
+				SizeT bLen = (lLen - st < rLen)? (lLen - st): rLen;
+				if(bLen == rLen){
+					_utility::mulKaratsuba(prod, _lhs + st, _rhs, rLen, scratch, threshold);
 				}
-				fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-					return tmp.data[static_cast<SizeT>(i)];
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				
-				for(SizeT i(0);i < N - L;++i){
-					_buf.data[k * L + i] += Ele(tmp.data[i] * inverseN);
+				else{
+					multiplyDigitsKaratsuba(prod, _rhs, rLen, _lhs + st, bLen);
 				}
-				SizeT i = N - L;
-				try{
-					for(;i < N;++i){
-						allocator.construct(_buf.data + k * L + i, Ele(tmp.data[i] * inverseN));
-					}
+				
+				if(0 == st){
+					std::copy(prod, prod + (bLen + rLen), res);
 				}
-				catch(...){
-					destroyAll(_buf.data, _buf.data + k * L + i, allocator);
-					allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-					_buf.data = nullptr;
-					_buf.zeroLen();
-					
-					throw ;
+				else{
+					// res[st, st + rLen) holds the high half of the previous block product
+					Ele carry = _utility::addDigits(res + st, res + st, prod, rLen);
+					carry = _utility::addDigit(res + (st + rLen), prod + rLen, bLen, carry);
+					assert(Ele(0) == carry);
 				}
 			}
+		}
+		
+		// x[0, xLen) += y[0, yLen), where the sum is known to fit in xLen digits
+		inline static void addDigitsTo(Ele *x, SizeT xLen, const Ele *y, SizeT yLen){
+			for(;(yLen > 0) && (Ele(0) == y[yLen - 1]);--yLen){}
+			assert(yLen <= xLen);
+			
+			Ele carry = _utility::addDigits(x, x, y, yLen);
+			carry = _utility::addDigit(x + yLen, x + yLen, xLen - yLen, carry);
+			assert(Ele(0) == carry);
+		}
+		// x[0, xLen) -= y[0, yLen), where the difference is known to be non-negative
+		inline static void subDigitsFrom(Ele *x, SizeT xLen, const Ele *y, SizeT yLen){
+			for(;(yLen > 0) && (Ele(0) == y[yLen - 1]);--yLen){}
+			assert(yLen <= xLen);
+			
+			Ele borrow = _utility::subDigits(x, x, y, yLen);
+			borrow = _utility::subDigit(x + yLen, x + yLen, xLen - yLen, borrow);
+			assert(Ele(0) == borrow);
+		}
+		// res[0, n) = |x[0, n) - y[0, yLen)| with yLen <= n, returns whether x < y
+		inline static bool absDiffDigits(Ele *res, const Ele *x, SizeT n, const Ele *y, SizeT yLen){
+			SizeT i = n;
+			for(;(i > yLen) && (Ele(0) == x[i - 1]);--i){}
+			bool less = (i == yLen) && (_utility::compareDigits(x, y, yLen) < 0);
+			
+			if(!less){
+				Ele borrow = _utility::subDigits(res, x, y, yLen);
+				borrow = _utility::subDigit(res + yLen, x + yLen, n - yLen, borrow);
+				assert(Ele(0) == borrow);
+			}
+			else{
+				_utility::subDigits(res, y, x, yLen);
+				std::fill(res + yLen, res + n, Ele(0));
+			}
+			return less;
+		}
+		// res[0, k + 1) = x[0, k) + y[0, yLen) with yLen <= k
+		inline static void addPieces(Ele *res, const Ele *x, SizeT k, const Ele *y, SizeT yLen){
+			Ele carry = _utility::addDigits(res, x, y, yLen);
+			res[k] = _utility::addDigit(res + yLen, x + yLen, k - yLen, carry);
+		}
+		// res[0, k + 1) = 2 * res[0, k + 1) + x[0, xLen)
+		inline static void doubleAddPiece(Ele *res, SizeT k, const Ele *x, SizeT xLen){
+			_utility::shlDigits(res, res, k + 1, 1);
+			addDigitsTo(res, k + 1, x, xLen);
+		}
+		
+		// res[0, xLen + yLen) = x * y for digits in any order
+		inline void multiplyDigitsAny(Ele *res, const Ele *x, SizeT xLen, const Ele *y, SizeT yLen){
+			SizeT _len = xLen + yLen;
+			// evaluated pieces often have a zero leading digit
+			for(;(xLen > 1) && (Ele(0) == x[xLen - 1]);--xLen){}
+			for(;(yLen > 1) && (Ele(0) == y[yLen - 1]);--yLen){}
 			
-			if(_left > 0){
-				fft1DPower2(static_cast<std::size_t>(N), root, [this, &_left, &_repe, &L](std::size_t i){
-					if(static_cast<std::size_t>(i) < _left){
-						return buf.data[_repe * L + static_cast<SizeT>(i)];
-					}
-					else{
-						return Ele(0);
+			if(xLen >= yLen){
+				multiplyDigitsToom(res, x, xLen, y, yLen);
+			}
+			else{
+				multiplyDigitsToom(res, y, yLen, x, xLen);
+			}
+			std::fill(res + (xLen + yLen), res + _len, Ele(0));
+		}
+		
+		// Toom-Cook multiplications, where each operand is cut into k-digit pieces, the
+		// piece polynomials are evaluated at a few points and multiplied there
+		// recursively, and the product polynomial is interpolated back. Only the value
+		// at -1 can be negative, which is tracked by a flag.
+		
+		// recovers c1, c2, c3 of a degree 4 product polynomial from its values at 1,
+		// -1 and 2 (each in L digits), and adds them at their offsets. res[0, 2k)
+		// holds c0 = v(0), res[4k, total) holds c4 = v(inf), res[2k, 4k) is zero.
+		inline static void interpolate5(Ele *res, SizeT total, SizeT k, 
+			Ele *v1, Ele *vm1, bool negative, Ele *v2, SizeT L){
+			const Ele *v0 = res, *vinf = res + 4 * k;
+			SizeT infLen = total - 4 * k;
+			
+			// v2 = (v(2) - v(-1)) / 3 = c1 + c2 + 3 * c3 + 5 * c4
+			if(negative){
+				addDigitsTo(v2, L, vm1, L);
+			}
+			else{
+				subDigitsFrom(v2, L, vm1, L);
+			}
+			_utility::divExactDigit(v2, v2, L, Ele(3));
+			// vm1 = (v(1) - v(-1)) / 2 = c1 + c3
+			if(negative){
+				addDigitsTo(vm1, L, v1, L);
+			}
+			else{
+				Ele borrow = _utility::subDigits(vm1, v1, vm1, L);
+				assert(Ele(0) == borrow);
+			}
+			_utility::shrDigits(vm1, vm1, L, 1);
+			// v1 = v(1) - v(0) = c1 + c2 + c3 + c4
+			subDigitsFrom(v1, L, v0, 2 * k);
+			// v2 = (v2 - v1) / 2 = c3 + 2 * c4
+			subDigitsFrom(v2, L, v1, L);
+			_utility::shrDigits(v2, v2, L, 1);
+			// v1 = c2, v2 = c3, vm1 = c1
+			subDigitsFrom(v1, L, vm1, L);
+			subDigitsFrom(v1, L, vinf, infLen);
+			subDigitsFrom(v2, L, vinf, infLen);
+			subDigitsFrom(v2, L, vinf, infLen);
+			subDigitsFrom(vm1, L, v2, L);
+			
+			addDigitsTo(res + k, total - k, vm1, L);
+			addDigitsTo(res + 2 * k, total - 2 * k, v1, L);
+			addDigitsTo(res + 3 * k, total - 3 * k, v2, L);
+		}
+		
+		// 3 x 3 pieces, evaluated at 0, 1, -1, 2 and infinity
+		inline void multiplyDigitsToom33(Ele *res, const Ele *a, SizeT an, const Ele *b, SizeT bn){
+			SizeT k = (an + 2) / 3;
+			assert((an > 2 * k) && (bn > 2 * k));
+			SizeT s = an - 2 * k, t = bn - 2 * k, L = 2 * k + 2;
+			
+			EleBuffer tmp(6 * (k + 1) + 3 * L, Ele(0), allocator);
+			Ele *as1 = tmp.data(), *asm1 = as1 + (k + 1), *as2 = asm1 + (k + 1);
+			Ele *bs1 = as2 + (k + 1), *bsm1 = bs1 + (k + 1), *bs2 = bsm1 + (k + 1);
+			Ele *v1 = bs2 + (k + 1), *vm1 = v1 + L, *v2 = vm1 + L;
+			
+			bool negative = false;
+			for(int i = 0;i < 2;++i){
+				const Ele *x = (0 == i)? a: b;
+				SizeT xLen = (0 == i)? s: t;
+				Ele *xs1 = (0 == i)? as1: bs1, *xsm1 = (0 == i)? asm1: bsm1, *xs2 = (0 == i)? as2: bs2;
+				
+				// x(1) = x0 + x1 + x2, x(-1) = x0 - x1 + x2
+				addPieces(xs1, x, k, x + 2 * k, xLen);
+				negative ^= absDiffDigits(xsm1, xs1, k + 1, x + k, k);
+				addDigitsTo(xs1, k + 1, x + k, k);
+				// x(2) = (2 * x2 + x1) * 2 + x0
+				std::copy(x + 2 * k, x + (2 * k + xLen), xs2);
+				doubleAddPiece(xs2, k, x + k, k);
+				doubleAddPiece(xs2, k, x, k);
+			}
+			
+			multiplyDigitsAny(v1, as1, k + 1, bs1, k + 1);
+			multiplyDigitsAny(vm1, asm1, k + 1, bsm1, k + 1);
+			multiplyDigitsAny(v2, as2, k + 1, bs2, k + 1);
+			multiplyDigitsAny(res, a, k, b, k);
+			multiplyDigitsAny(res + 4 * k, a + 2 * k, s, b + 2 * k, t);
+			std::fill(res + 2 * k, res + 4 * k, Ele(0));
+			
+			interpolate5(res, an + bn, k, v1, vm1, negative, v2, L);
+		}
+		
+		// 4 x 2 pieces, evaluated at 0, 1, -1, 2 and infinity
+		inline void multiplyDigitsToom42(Ele *res, const Ele *a, SizeT an, const Ele *b, SizeT bn){
+			SizeT k = std::max<SizeT>((an + 3) / 4, (bn + 1) / 2);
+			assert((an > 3 * k) && (bn > k));
+			SizeT s = an - 3 * k, t = bn - k, L = 2 * k + 2;
+			
+			EleBuffer tmp(7 * (k + 1) + 3 * L, Ele(0), allocator);
+			Ele *as1 = tmp.data(), *asm1 = as1 + (k + 1), *as2 = asm1 + (k + 1), *odd = as2 + (k + 1);
+			Ele *bs1 = odd + (k + 1), *bsm1 = bs1 + (k + 1), *bs2 = bsm1 + (k + 1);
+			Ele *v1 = bs2 + (k + 1), *vm1 = v1 + L, *v2 = vm1 + L;
+			
+			// a(1) = (a0 + a2) + (a1 + a3), a(-1) = (a0 + a2) - (a1 + a3)
+			addPieces(as1, a, k, a + 2 * k, k);
+			addPieces(odd, a + k, k, a + 3 * k, s);
+			bool negative = absDiffDigits(asm1, as1, k + 1, odd, k + 1);
+			addDigitsTo(as1, k + 1, odd, k + 1);
+			// a(2) = ((2 * a3 + a2) * 2 + a1) * 2 + a0
+			std::copy(a + 3 * k, a + (3 * k + s), as2);
+			doubleAddPiece(as2, k, a + 2 * k, k);
+			doubleAddPiece(as2, k, a + k, k);
+			doubleAddPiece(as2, k, a, k);
+			
+			// b(1) = b0 + b1, b(-1) = b0 - b1, b(2) = 2 * b1 + b0
+			addPieces(bs1, b, k, b + k, t);
+			negative ^= absDiffDigits(bsm1, b, k, b + k, t);
+			std::copy(b + k, b + (k + t), bs2);
+			doubleAddPiece(bs2, k, b, k);
+			
+			multiplyDigitsAny(v1, as1, k + 1, bs1, k + 1);
+			multiplyDigitsAny(vm1, asm1, k + 1, bsm1, k + 1);
+			multiplyDigitsAny(v2, as2, k + 1, bs2, k + 1);
+			multiplyDigitsAny(res, a, k, b, k);
+			multiplyDigitsAny(res + 4 * k, a + 3 * k, s, b + k, t);
+			std::fill(res + 2 * k, res + 4 * k, Ele(0));
+			
+			interpolate5(res, an + bn, k, v1, vm1, negative, v2, L);
+		}
+		
+		// 3 x 2 pieces, evaluated at 0, 1, -1 and infinity
+		inline void multiplyDigitsToom32(Ele *res, const Ele *a, SizeT an, const Ele *b, SizeT bn){
+			SizeT k = std::max<SizeT>((an + 2) / 3, (bn + 1) / 2);
+			assert((an > 2 * k) && (bn > k));
+			SizeT s = an - 2 * k, t = bn - k, L = 2 * k + 2;
+			
+			EleBuffer tmp(4 * (k + 1) + 2 * L, Ele(0), allocator);
+			Ele *as1 = tmp.data(), *asm1 = as1 + (k + 1), *bs1 = asm1 + (k + 1), *bsm1 = bs1 + (k + 1);
+			Ele *v1 = bsm1 + (k + 1), *vm1 = v1 + L;
+			
+			addPieces(as1, a, k, a + 2 * k, s);
+			bool negative = absDiffDigits(asm1, as1, k + 1, a + k, k);
+			addDigitsTo(as1, k + 1, a + k, k);
+			addPieces(bs1, b, k, b + k, t);
+			negative ^= absDiffDigits(bsm1, b, k, b + k, t);
+			
+			multiplyDigitsAny(v1, as1, k + 1, bs1, k + 1);
+			multiplyDigitsAny(vm1, asm1, k + 1, bsm1, k);
+			multiplyDigitsAny(res, a, k, b, k);
+			multiplyDigitsAny(res + 3 * k, a + 2 * k, s, b + k, t);
+			std::fill(res + 2 * k, res + 3 * k, Ele(0));
+			vm1[L - 1] = Ele(0);
+			
+			// vm1 = v(1) - v(-1) = 2 * (c1 + c3), v1 = 2 * v(1) - vm1 = 2 * (c0 + c2)
+			if(negative){
+				addDigitsTo(vm1, L, v1, L);
+			}
+			else{
+				Ele borrow = _utility::subDigits(vm1, v1, vm1, L);
+				assert(Ele(0) == borrow);
+			}
+			_utility::shlDigits(v1, v1, L, 1);
+			subDigitsFrom(v1, L, vm1, L);
+			_utility::shrDigits(vm1, vm1, L, 1);
+			_utility::shrDigits(v1, v1, L, 1);
+			subDigitsFrom(vm1, L, res + 3 * k, s + t);
+			subDigitsFrom(v1, L, res, 2 * k);
+			
+			addDigitsTo(res + k, an + bn - k, vm1, L);
+			addDigitsTo(res + 2 * k, an + bn - 2 * k, v1, L);
+		}
+		
+		// res[0, an + bn) = a[0, an) * b[0, bn) for an >= bn, picking Karatsuba's method
+		// or a Toom-Cook variant by the operand lengths
+		inline void multiplyDigitsToom(Ele *res, const Ele *a, SizeT an, const Ele *b, SizeT bn){
+			assert(an >= bn);
+			
+			std::uintmax_t m = an, n = bn;
+			if(bn >= _BIG_NUM_MUL_TOOM3_THRESHOLD_){
+				if(4 * m < 5 * n){
+					if(bn > 2 * ((an + 2) / 3)){
+						multiplyDigitsToom33(res, a, an, b, bn);
+						return ;
 					}
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N;++i){
-					tmp.data[i] = Ele(ModularP_T(tmp.data[i]) * ModularP_T(rBuf.data[i]));
 				}
-				fft1DPower2(static_cast<std::size_t>(tmp.len), invRoot, [&tmp](std::size_t i){
-					return tmp.data[static_cast<SizeT>(i)];
-				}, [&tmp](std::size_t i) -> Ele &{
-					return tmp.data[static_cast<SizeT>(i)];
-				});
-				for(SizeT i(0);i < N - L;++i){
-					_buf.data[_repe * L + i] += Ele(tmp.data[i] * inverseN);
+				else if(4 * m < 7 * n){
+					SizeT k = std::max<SizeT>((an + 2) / 3, (bn + 1) / 2);
+					if((an > 2 * k) && (bn > k)){
+						multiplyDigitsToom32(res, a, an, b, bn);
+						return ;
+					}
 				}
-				i = N - L;
-				try{
-					assert(_repe * L + N >= _len);
-					for(;i < _len - _repe * L;++i){
-						allocator.construct(_buf.data + _repe * L + i, Ele(tmp.data[i] * inverseN));
+				else if(2 * m < 5 * n){
+					SizeT k = std::max<SizeT>((an + 3) / 4, (bn + 1) / 2);
+					if((an > 3 * k) && (bn > k)){
+						multiplyDigitsToom42(res, a, an, b, bn);
+						return ;
 					}
 				}
-				catch(...){
-					destroyAll(_buf.data, _buf.data + _repe * L + i, allocator);
-					allocator.deallocate(_buf.data, static_cast<std::size_t>(_buf.cap));
-					_buf.data = nullptr;
-					_buf.zeroLen();
-					
-					throw ;
+				else{
+					// a is cut into bn-digit blocks, whose products are balanced
+					EleBuffer tmp(2 * bn, Ele(0), allocator);
+					for(SizeT st(0);st < an;st += bn){
+						SizeT bLen = (an - st < bn)? (an - st): bn;
+						multiplyDigitsAny(tmp.data(), a + st, bLen, b, bn);
+						if(0 == st){
+							std::copy(tmp.data(), tmp.data() + (bLen + bn), res);
+						}
+						else{
+							Ele carry = _utility::addDigits(res + st, res + st, tmp.data(), bn);
+							carry = _utility::addDigit(res + (st + bn), tmp.data() + bn, bLen, carry);
+							assert(Ele(0) == carry);
+						}
+					}
+					return ;
 				}
 			}
-			_buf.propagateCarry();
-			_buf.shrinkToFit();
 			
-			destroyAll(buf.data, buf.data + buf.len, allocator);
-			allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-			buf.data = _buf.data;
-			buf.len = _buf.len;
-			buf.cap = _buf.cap;
-			_buf.data = nullptr;
-			_buf.zeroLen();
+			multiplyDigitsKaratsuba(res, a, an, b, bn);
+		}
+		
+		// res[0, 2an) = a[0, an) ^ 2 by Toom-3, like multiplyDigitsToom33 with a single
+		// evaluation. The value at -1 is squared, so its sign does not matter.
+		inline void squareDigitsToom3(Ele *res, const Ele *a, SizeT an){
+			SizeT k = (an + 2) / 3;
+			assert(an > 2 * k);
+			SizeT s = an - 2 * k, L = 2 * k + 2;
+			
+			EleBuffer tmp(3 * (k + 1) + 3 * L, Ele(0), allocator);
+			Ele *as1 = tmp.data(), *asm1 = as1 + (k + 1), *as2 = asm1 + (k + 1);
+			Ele *v1 = as2 + (k + 1), *vm1 = v1 + L, *v2 = vm1 + L;
+			
+			addPieces(as1, a, k, a + 2 * k, s);
+			absDiffDigits(asm1, as1, k + 1, a + k, k);
+			addDigitsTo(as1, k + 1, a + k, k);
+			std::copy(a + 2 * k, a + (2 * k + s), as2);
+			doubleAddPiece(as2, k, a + k, k);
+			doubleAddPiece(as2, k, a, k);
+			
+			squareDigitsAny(v1, as1, k + 1);
+			squareDigitsAny(vm1, asm1, k + 1);
+			squareDigitsAny(v2, as2, k + 1);
+			squareDigitsAny(res, a, k);
+			squareDigitsAny(res + 4 * k, a + 2 * k, s);
+			std::fill(res + 2 * k, res + 4 * k, Ele(0));
+			
+			interpolate5(res, 2 * an, k, v1, vm1, false, v2, L);
+		}
+		
+		// res[0, 2xLen) = x[0, xLen) ^ 2 by the squaring counterparts of the basecase,
+		// Karatsuba and Toom-3 multiplications, which save the products that
+		// appear twice
+		inline void squareDigitsAny(Ele *res, const Ele *x, SizeT xLen){
+			SizeT _len = 2 * xLen;
+			for(;(xLen > 1) && (Ele(0) == x[xLen - 1]);--xLen){}
 			
-			return ;
+			if(xLen < _BIG_NUM_MUL_BASECASE_THRESHOLD_){
+				_utility::sqrDigits(res, x, xLen);
+			}
+			else if(xLen < _BIG_NUM_MUL_TOOM3_THRESHOLD_){
+				SizeT threshold = _BIG_NUM_MUL_BASECASE_THRESHOLD_;
+				EleBuffer scratch(_utility::karatsubaScratchLen(xLen, threshold), Ele(0), allocator);
+				_utility::sqrKaratsuba(res, x, xLen, scratch.data(), threshold);
+			}
+			else{
+				squareDigitsToom3(res, x, xLen);
+			}
+			std::fill(res + 2 * xLen, res + _len, Ele(0));
 		}
-#ifdef _BIG_NUM_DEBUG_
 		
-		void trivalMultiply(const BigInt &_rhs){
-			positive = (positive == _rhs.positive);
+		void multiplyToomCook(const BigInt &_rhs){
+			bool _positive = (positive == _rhs.positive);
+			
 			SizeT _len = buf.len + _rhs.buf.len;
 			if(_len > MAX_LEN){
-				throw std::out_of_range("BigInt::trivalMultiply");
+				throw std::out_of_range("BigInt::multiplyToomCook");
+				// errno = ERANGE;
 			}
-			DigitBuffer tmp(&allocator, nullptr);
-			tmp.setLen(_len);
-			tmp.data = allocator.allocate(static_cast<std::size_t>(tmp.cap));
-			SizeT i = 0, j = 0;
+			
+			DigitBuffer _buf(&allocator, _len);
+			constructZeroDigits(_buf);
 			try{
-				for(;i < tmp.len;++i){
-					allocator.construct(tmp.data + i, 0);
-				}
+				multiplyDigitsAny(_buf.data, buf.data, buf.len, _rhs.buf.data, _rhs.buf.len);
 			}
 			catch(...){
-				destroyAll(tmp.data, tmp.data + i, allocator);
-				allocator.deallocate(tmp.data, static_cast<std::size_t>(tmp.cap));
-				tmp.data = nullptr;
-				tmp.zeroLen();
+				releaseDigits(_buf);
 				throw ;
 			}
-			for(i = 0;i < buf.len;++i){
-				for(j= 0;j < _rhs.buf.len;++j){
-					tmp.data[i + j] += buf.data[i] * _rhs.buf.data[j];
-				}
-				tmp.propagateCarry();
-			}
 			
-			tmp.propagateCarry();
-			tmp.shrinkToFit();
+			takeDigits(_buf);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
+		}
+#ifdef _BIG_NUM_DEBUG_
+		
+		void trivalMultiply(const BigInt &_rhs){
+			bool _positive = (positive == _rhs.positive);
+			SizeT _len = buf.len + _rhs.buf.len;
+			if(_len > MAX_LEN){
+				throw std::out_of_range("BigInt::trivalMultiply");
+			}
+			DigitBuffer tmp(&allocator, _len);
+			constructZeroDigits(tmp);
+			for(SizeT i(0);i < buf.len;++i){
+				tmp.data[i + _rhs.buf.len] = _utility::addMulDigit(tmp.data + i, _rhs.buf.data, _rhs.buf.len, buf.data[i]);
+			}
 			
-			destroyAll(buf.data, buf.data + buf.len, allocator);
-			allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-			buf.data = tmp.data;
-			buf.len = tmp.len;
-			buf.cap = tmp.cap;
-			tmp.data = nullptr;
-			tmp.zeroLen();
+			takeDigits(tmp);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
 			return ;
 		}
 #endif // _BIG_NUM_DEBUG_
 		
+		// whether |this| == |_rhs|, so that their product is a square
+		inline bool isSameMagnitude(const BigInt &_rhs) const{
+			if(buf.len != _rhs.buf.len){
+				return false;
+			}
+			return (buf.data == _rhs.buf.data) || (0 == _utility::compareDigits(buf.data, _rhs.buf.data, buf.len));
+		}
+		
 		void multiply(BigInt &&_rhs){
 			constexpr auto _SMALL_MEDIUM_THRESHOLD_ = 2;
 			
@@ -3065,7 +3611,23 @@ namespace bignum{
 				zerolize();
 				return ;
 			}
+			if(isSameMagnitude(_rhs)){
+				// selfMultiply() leaves the square positive
+				bool _positive = (positive == _rhs.positive);
+				selfMultiply();
+				positive = _positive;
+				return ;
+			}
 			
+			SizeT minLen = (buf.len < _rhs.buf.len)? buf.len: _rhs.buf.len;
+			if(minLen < _BIG_NUM_MUL_BASECASE_THRESHOLD_){
+				multiplyBasecase(_rhs);
+				return ;
+			}
+			if(minLen < nttThreshold()){
+				multiplyToomCook(_rhs);
+				return ;
+			}
 			if(buf.len >= _rhs.buf.len * _SMALL_MEDIUM_THRESHOLD_){
 				multiplySmall(std::move(_rhs));
 				return ;
@@ -3092,39 +3654,157 @@ namespace bignum{
 				zerolize();
 				return ;
 			}
+			if(isSameMagnitude(_rhs)){
+				// selfMultiply() leaves the square positive
+				bool _positive = (positive == _rhs.positive);
+				selfMultiply();
+				positive = _positive;
+				return ;
+			}
 			
+			SizeT minLen = (buf.len < _rhs.buf.len)? buf.len: _rhs.buf.len;
+			if(minLen < _BIG_NUM_MUL_BASECASE_THRESHOLD_){
+				multiplyBasecase(_rhs);
+				return ;
+			}
+			if(minLen < nttThreshold()){
+				multiplyToomCook(_rhs);
+				return ;
+			}
 			if(buf.len >= _rhs.buf.len * _SMALL_MEDIUM_THRESHOLD_){
 				multiplySmall(_rhs);
 				return ;
 			}
-			if(_rhs.buf.len < buf.len * _SMALL_MEDIUM_THRESHOLD_){
-				multiplyMedium(_rhs);
-				return ;
+			if(_rhs.buf.len < buf.len * _SMALL_MEDIUM_THRESHOLD_){
+				multiplyMedium(_rhs);
+				return ;
+			}
+			assert(_rhs.buf.len >= buf.len * _SMALL_MEDIUM_THRESHOLD_);
+			BigInt tmp = _rhs;
+			tmp.multiplySmall(std::move(*this));
+			*this = std::move(tmp);
+			return ;
+			//multiplyMedium(_rhs);
+			//trivalMultiply(_rhs);
+		}
+		// this *= _rhs, reusing the transforms of _rhs kept in rCache for NTT products.
+		// A much longer this is cut into blocks against the single transform of _rhs,
+		// while a much longer _rhs only needs this to be transformed. Products below
+		// the NTT threshold, or a null rCache, go through multiply().
+		void multiplyCached(const BigInt &_rhs, TransformCache *rCache){
+			SizeT minLen = (buf.len < _rhs.buf.len)? buf.len: _rhs.buf.len;
+			if((nullptr == rCache) || isZero() || _rhs.isZero() || (minLen < nttThreshold())){
+				multiply(_rhs);
+				return ;
+			}
+			if(buf.len >= 2 * _rhs.buf.len){
+				multiplySmall(_rhs, rCache);
+				return ;
+			}
+			multiplyMedium(_rhs, rCache);
+		}
+		inline static BigInt multiplyCached(BigInt _lhs, const BigInt &_rhs, TransformCache *rCache){
+			_lhs.multiplyCached(_rhs, rCache);
+			return _lhs;
+		}
+		
+		// this -= _lhs * _rhs, where the difference is known to be below beta^{resLen}
+		// in absolute value, as for the remainder of a division by _rhs with a nearly
+		// exact quotient. Only the difference modulo beta^{L} - 1 is needed then, for
+		// the power of 2 L > resLen, so the product is a cyclic convolution of 2 * L
+		// coefficients wrapping around, about half the size of the full product.
+		void subMultiply(const BigInt &_lhs, const BigInt &_rhs, SizeT resLen, TransformCache *rCache = nullptr){
+			SizeT lLen = _lhs.buf.len, rLen = _rhs.buf.len;
+			SizeT N = ceilPower2((resLen + 1) * COEF_PER_ELE);
+			SizeT L = N / COEF_PER_ELE;
+			if(_lhs.isZero() || _rhs.isZero() || (std::min(lLen, rLen) < nttThreshold()) || 
+				(lLen + rLen <= L) || (std::max(lLen, rLen) > L) || (lLen + rLen > PRI_ORDER / COEF_PER_ELE)){
+				sub(multiplyCached(_lhs, _rhs, rCache));
+				return ;
+			}
+			
+			// the coefficients of the cyclic product add up to less than beta^{L + 2}
+			EleBuffer prod(L + 2, Ele(0), allocator);
+			{
+				CoefBuffers lCoefs(allocator), rOwn(allocator);
+				const CoefBuffers *rCoefs = &rOwn;
+				if(nullptr != rCache){
+					rCoefs = &cachedTransform(*rCache, _rhs.buf.data, rLen, N, 0).coefs;
+				}
+				else{
+					transformDigits(rOwn, _rhs.buf.data, rLen, N);
+				}
+				transformDigits(lCoefs, _lhs.buf.data, lLen, N);
+				pointwiseMultiply(lCoefs, *rCoefs);
+				inverseTransform(lCoefs);
+				addCoefs(prod.data(), L + 2, lCoefs, N);
+			}
+			foldDigits(prod.data(), L, prod.data() + L, 2);
+			
+			DigitBuffer _buf(&allocator, L);
+			constructZeroDigits(_buf);
+			for(SizeT st(0);st < buf.len;st += L){
+				foldDigits(_buf.data, L, buf.data + st, (buf.len - st < L)? (buf.len - st): L);
+			}
+			
+			// the residues of this and the product, negated modulo beta^{L} - 1 by
+			// complementing every digit
+			if(!positive){
+				complementDigits(_buf.data, L);
+			}
+			if(_lhs.positive != _rhs.positive){
+				complementDigits(prod.data(), L);
+			}
+			if(Ele(0) != _utility::subDigits(_buf.data, _buf.data, prod.data(), L)){
+				_utility::subDigit(_buf.data, _buf.data, L, Ele(1));
+			}
+			
+			bool _positive = (Ele(0) == (_buf.data[L - 1] >> (ENTRY_SIZE - 1)));
+			if(!_positive){
+				complementDigits(_buf.data, L);
+			}
+			takeDigits(_buf);
+			buf.shrinkToFit();
+			positive = _positive || buf.isZero();
+		}
+		
+		// res[0, L) += digits[0, len) modulo beta^{L} - 1, where len <= L
+		inline static void foldDigits(Ele *res, SizeT L, const Ele *digits, SizeT len) noexcept{
+			assert(len <= L);
+			
+			Ele carry = _utility::addDigits(res, res, digits, len);
+			carry = _utility::addDigit(res + len, res + len, L - len, carry);
+			while(Ele(0) != carry){
+				carry = _utility::addDigit(res, res, L, carry);
+			}
+		}
+		
+		inline static void complementDigits(Ele *digits, SizeT len) noexcept{
+			for(SizeT i(0);i < len;++i){
+				digits[i] = ~digits[i];
 			}
-			assert(_rhs.buf.len >= buf.len * _SMALL_MEDIUM_THRESHOLD_);
-			BigInt tmp = _rhs;
-			tmp.multiplySmall(std::move(*this));
-			*this = std::move(tmp);
-			return ;
-			//multiplyMedium(_rhs);
-			//trivalMultiply(_rhs);
 		}
 		
-		// case for unsigned int type small enough to be hold in a uint{ENTRY_SIZE}_t
-		// so that the iterate integer multiply won't overflow since Ele is 
-		// uleast{2*ENTRY_SIZE}_t
+		// case for unsigned int type small enough to be hold in a single digit
 		template <typename UnsignedInt>
 		inline void multiplyUnsignedInt(const UnsignedInt &_rhs, std::true_type){
-			for(SizeT i(0);i < buf.len;++i){
-				buf.data[i] *= _rhs;
+			if(UnsignedInt(0) == _rhs){
+				zerolize();
+				return ;
 			}
 			
-			buf.propagateCarry();
+			Ele carry = _utility::mulDigit(buf.data, buf.data, buf.len, static_cast<Ele>(_rhs));
+			if(Ele(0) != carry){
+				buf.resize(buf.len + 1);
+				buf.data[buf.len - 1] = carry;
+			}
 		}
 		// case for large integer types
 		template <typename UnsignedInt>
 		inline void multiplyUnsignedInt(const UnsignedInt &_rhs, std::false_type){
-			if(_rhs < static_cast<UnsignedInt>(1 << ENTRY_SIZE)){
+			using Common = typename std::common_type<Ele, UnsignedInt>::type;
+			
+			if(Common(0) == shrEntry(static_cast<Common>(_rhs))){
 				multiplyUnsignedInt<Ele>(static_cast<Ele>(_rhs), std::true_type{});
 				return ;
 			}
@@ -3143,244 +3823,158 @@ namespace bignum{
 		// signed integer
 		template <typename Integer>
 		inline void multiplyInt(Integer _rhs, std::true_type){
+			using Unsigned = typename std::make_unsigned<Integer>::type;
+			
 			if(_rhs < Integer(0)){
-				positive = !positive;
-				
-				if(Integer(1 << (sizeof(Integer) * CHAR_BIT - 1)) == _rhs){
-					shl(sizeof(Integer) * CHAR_BIT - 1, std::false_type());
-					return ;
-				}
-				
-				multiplyUnsignedInt(static_cast<typename std::make_unsigned<Integer>::type>(-_rhs), std::false_type{});
+				multiplyUnsignedInt(static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(_rhs)), 
+					std::integral_constant<bool, sizeof(Integer) * CHAR_BIT <= ENTRY_SIZE>{});
+				changeSign();
 				return ;
 			}
 			else{
-				multiplyUnsignedInt(static_cast<typename std::make_unsigned<Integer>::type>(_rhs), std::false_type{});
+				multiplyUnsignedInt(static_cast<Unsigned>(_rhs), 
+					std::integral_constant<bool, sizeof(Integer) * CHAR_BIT <= ENTRY_SIZE>{});
 				return ;
 			}
 		}
 		
+		// the absolute value truncated to UnsignedInt
 		template <typename UnsignedInt>
 		inline UnsignedInt convertSingleDigit() const{
-			UnsignedInt digit(0);
-			for(SizeT i = buf.len - 1;true;--i){
-				assert((digit < (digit << ENTRY_SIZE) + static_cast<UnsignedInt>(buf.data[i]))
-					|| (isZero()));
-				digit = (digit << ENTRY_SIZE) + static_cast<UnsignedInt>(buf.data[i]);
-				if(i == 0){
-					break;
-				}
+			using Common = typename std::common_type<Ele, UnsignedInt>::type;
+			
+			Common digit(0);
+			for(SizeT i = buf.len;i > 0;--i){
+				digit = shlEntry(digit) | static_cast<Common>(buf.data[i - 1]);
 			}
-			return digit;
+			return static_cast<UnsignedInt>(digit);
 		}
+		// the lowest kBits bits of the absolute value
 		template <typename UnsignedInt>
 		inline UnsignedInt convertSingleDigit(SizeT kBits) const{
+			using Common = typename std::common_type<Ele, UnsignedInt>::type;
+			
 			SizeT padLen = kBits / ENTRY_SIZE;
 			LogSizeT leftLen = kBits % ENTRY_SIZE;
 			if(buf.len <= padLen){
 				return convertSingleDigit<UnsignedInt>();
 			}
 			
-			UnsignedInt digit = buf.data[padLen] & (static_cast<UnsignedInt>(1 << leftLen) - 1);
+			Common digit = static_cast<Common>(buf.data[padLen] & ((Ele(1) << leftLen) - 1));
 			for(SizeT i = padLen;i > 0;--i){
-				assert((digit < (digit << ENTRY_SIZE) + static_cast<UnsignedInt>(buf.data[i - 1]))
-					|| (isZero()));
-				digit = (digit << ENTRY_SIZE) + static_cast<UnsignedInt>(buf.data[i - 1]);
+				digit = shlEntry(digit) | static_cast<Common>(buf.data[i - 1]);
 			}
-			return digit;
+			return static_cast<UnsignedInt>(digit);
 		}
 		
 		// this = (this * _rhs) / beta^{k}
-		// TODO: optimization since the lowest k digits is sure to be truncated
-		inline void multiplyShr(BigInt &&_rhs, SizeT k){
-			bool _positive = positive == _rhs.positive;
-			
-			if(buf.len + _rhs.buf.len <= MAX_LEN){
-				multiply(std::move(_rhs));
-				shr(k, std::false_type{});
-				positive = _positive;
-				
-				return ;
-			}
-			
-			if(buf.len <= MAX_LEN / 2){
-				assert(_rhs.buf.len > MAX_LEN / 2);
-				BigInt r1 = _rhs.subStr(MAX_LEN >> 1, 0);
-				BigInt r2 = std::move(_rhs).subStr(0, MAX_LEN >> 1);
-				
-				BigInt m1 = (*this) * std::move(r1);
-				if(k < MAX_LEN / 2 * ENTRY_SIZE){
-					m1.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				}
-				else{
-					m1.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				}
-				
-				BigInt m2 = std::move(*this) * std::move(r2);
-				m2.shr(k, std::false_type{});
-				
-				*this = m1 + m2;
-				positive = _positive;
-				
-				return ;
-			}
-			if(_rhs.buf.len <= MAX_LEN / 2){
-				assert(buf.len > MAX_LEN / 2);
-				BigInt l1 = subStr(MAX_LEN >> 1, 0);
-				BigInt l2 = std::move(*this).subStr(0, MAX_LEN >> 1);
-				
-				BigInt m1 = std::move(l1) * _rhs;
-				if(k < MAX_LEN / 2 * ENTRY_SIZE){
-					m1.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				}
-				else{
-					m1.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				}
-				
-				BigInt m2 = std::move(l2) * std::move(_rhs);
-				m2.shr(k, std::false_type{});
-				
-				*this = m1 + m2;
-				positive = _positive;
-				
+		// a full product, since wrapping it would fold the wanted top digits down
+		inline void multiplyShr(BigInt &&_rhs, SizeT k, TransformCache *rCache = nullptr){
+			if(nullptr != rCache){
+				multiplyShr(static_cast<const BigInt &>(_rhs), k, rCache);
 				return ;
 			}
+			bool _positive = positive == _rhs.positive;
 			
-			assert(buf.len > MAX_LEN / 2);
-			assert(_rhs.buf.len > MAX_LEN / 2);
-			
-			BigInt l1 = subStr(MAX_LEN / 2, 0);
-			BigInt r1 = _rhs.subStr(MAX_LEN / 2, 0);
-			
-			BigInt m1 = l1 * r1;
-			if(k < MAX_LEN * ENTRY_SIZE){
-				m1.shl(MAX_LEN * ENTRY_SIZE - k, std::false_type{});
-			}
-			else{
-				m1.shr(k - MAX_LEN * ENTRY_SIZE, std::false_type{});
-			}
-			
-			BigInt r2 = std::move(_rhs).subStr(0, MAX_LEN / 2);
-			BigInt m2 = std::move(l1) * r2;
-			BigInt l2 = std::move(*this).subStr(0, MAX_LEN / 2);
-			BigInt m3 = l2 * std::move(r1);
-			if(k < MAX_LEN / 2 * ENTRY_SIZE){
-				m2.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				m3.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-			}
-			else{
-				m2.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				m3.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-			}
-			
-			BigInt m4 = std::move(l2) * std::move(r2);
-			m4.shr(k, std::false_type{});
-			
-			*this = m1 + m2 + m3 + m4;
-			positive = _positive;
-			
-			return ;
+			multiply(std::move(_rhs));
+			shr(k, std::false_type{});
+			positive = _positive || buf.isZero();
 		}
-		inline void multiplyShr(const BigInt &_rhs, SizeT k){
+		inline void multiplyShr(const BigInt &_rhs, SizeT k, TransformCache *rCache = nullptr){
 			bool _positive = positive == _rhs.positive;
 			
-			if(buf.len + _rhs.buf.len <= MAX_LEN){
-				multiply(_rhs);
-				shr(k, std::false_type{});
-				positive = _positive;
-				return ;
-			}
-			
-			if(buf.len <= MAX_LEN / 2){
-				assert(_rhs.buf.len > MAX_LEN / 2);
-				BigInt r1 = _rhs.subStr(MAX_LEN >> 1, 0);
-				BigInt r2 = _rhs.subStr(0, MAX_LEN >> 1);
-				
-				BigInt m1 = (*this) * std::move(r1);
-				if(k < MAX_LEN / 2 * ENTRY_SIZE){
-					m1.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				}
-				else{
-					m1.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				}
-				
-				BigInt m2 = std::move(*this) * std::move(r2);
-				m2.shr(k, std::false_type{});
-				
-				*this = m1 + m2;
-				positive = _positive;
-				
-				return ;
-			}
-			if(_rhs.buf.len <= MAX_LEN / 2){
-				assert(buf.len > MAX_LEN / 2);
-				BigInt l1 = subStr(MAX_LEN >> 1, 0);
-				BigInt l2 = std::move(*this).subStr(0, MAX_LEN >> 1);
-				
-				BigInt m1 = std::move(l1) * _rhs;
-				if(k < MAX_LEN / 2 * ENTRY_SIZE){
-					m1.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				}
-				else{
-					m1.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				}
-				
-				BigInt m2 = std::move(l2) * _rhs;
-				m2.shr(k, std::false_type{});
-				
-				*this = m1 + m2;
-				positive = _positive;
-				
-				return ;
-			}
-			
-			assert(buf.len > MAX_LEN / 2);
-			assert(_rhs.buf.len > MAX_LEN / 2);
-			
-			BigInt l1 = subStr(MAX_LEN / 2, 0);
-			BigInt r1 = _rhs.subStr(MAX_LEN / 2, 0);
-			
-			BigInt m1 = l1 * r1;
-			if(k < MAX_LEN * ENTRY_SIZE){
-				m1.shl(MAX_LEN * ENTRY_SIZE - k, std::false_type{});
-			}
-			else{
-				m1.shr(k - MAX_LEN * ENTRY_SIZE, std::false_type{});
-			}
-			
-			BigInt r2 = _rhs.subStr(0, MAX_LEN / 2);
-			BigInt m2 = std::move(l1) * r2;
-			BigInt l2 = std::move(*this).subStr(0, MAX_LEN / 2);
-			BigInt m3 = l2 * std::move(r1);
-			if(k < MAX_LEN / 2 * ENTRY_SIZE){
-				m2.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-				m3.shl(MAX_LEN / 2 * ENTRY_SIZE - k, std::false_type{});
-			}
-			else{
-				m2.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-				m3.shr(k - MAX_LEN / 2 * ENTRY_SIZE, std::false_type{});
-			}
-			
-			BigInt m4 = std::move(l2) * std::move(r2);
-			m4.shr(k, std::false_type{});
-			
-			*this = m1 + m2 + m3 + m4;
-			positive = _positive;
-			
-			return ;
+			multiplyCached(_rhs, rCache);
+			shr(k, std::false_type{});
+			positive = _positive || buf.isZero();
 		}
 		
-		// TODO: full implemetation
-		inline void multiplyTruncate(BigInt &&_rhs, SizeT k){
-			multiplyShr(std::move(_rhs), k * ENTRY_SIZE);
+		// multiplyShr() by k whole digits
+		inline void multiplyTruncate(BigInt &&_rhs, SizeT k, TransformCache *rCache = nullptr){
+			multiplyShr(std::move(_rhs), k * ENTRY_SIZE, rCache);
 		}
-		inline void multiplyTruncate(const BigInt &_rhs, SizeT k){
-			multiplyShr(_rhs, k * ENTRY_SIZE);
+		inline void multiplyTruncate(const BigInt &_rhs, SizeT k, TransformCache *rCache = nullptr){
+			multiplyShr(_rhs, k * ENTRY_SIZE, rCache);
 		}
 		
 		// floor(beta^{k} / this)
 		// here we specify beta = 2 to converage more quickly
+		// 
+		// a quotient of m = k - lenBin bits only depends on the top bits of this, so a
+		// longer this is truncated first. The reciprocal at half the precision is
+		// then found recursively from the top bits, and a single Newton step at the
+		// full precision doubles its correct bits. Short quotients iterate directly.
 		inline BigInt newtonInverse(SizeT k) const{
+			constexpr SizeT GUARD = ENTRY_SIZE;
+			
+			SizeT lenBin = lenOfBinary();
+			SizeT m = (k > lenBin)? (k - lenBin): 0;
+			if((m > 0) && (lenBin > m + GUARD)){
+				SizeT s = lenBin - m - GUARD;
+				BigInt x = (*this >> s).newtonInverse(k - s);
+				BigInt r = inverseRemainder(x, k);
+				correctInverse(x, r);
+				return x;
+			}
+			if(m <= 4 * GUARD){
+				BigInt x = newtonInverseBasecase(k);
+				BigInt r = inverseRemainder(x, k);
+				correctInverse(x, r);
+				return x;
+			}
+			
+			// y approximates beta^{k - t} / this within a few units
+			SizeT t = (m - GUARD) / 2;
+			SizeT s = (lenBin > m - t + GUARD)? (lenBin - (m - t) - GUARD): 0;
+			BigInt y = (0 == s)? newtonInverse(k - t): (*this >> s).newtonInverse(k - t - s);
+			
+			// r = beta^{k} - x * this for x = y * beta^{t}. beta^{k - t} - y * this is
+			// within a few multiples of this.
+			BigInt r = static_cast<BigInt>(1);
+			r.shl(k - t, std::false_type{});
+			r.subMultiply(y, *this, buf.len + 1);
+			r.shl(t, std::false_type{});
+			
+			// x += x * r / beta^{k}, where only the top bits of r matter
+			SizeT lenR = r.lenOfBinary();
+			SizeT u = (lenR > t + GUARD)? (lenR - t - GUARD): 0;
+			if(u > k - t){
+				u = k - t;
+			}
+			BigInt delta = r >> u;
+			delta.multiplyShr(y, k - t - u);
+			
+			BigInt x = std::move(y);
+			x.shl(t, std::false_type{});
+			x.add(delta);
+			r.subMultiply(delta, *this, buf.len + 1);
+			correctInverse(x, r);
+			return x;
+		}
+		
+		// beta^{k} - x * this
+		inline BigInt inverseRemainder(const BigInt &x, SizeT k) const{
+			BigInt r = static_cast<BigInt>(1);
+			r.shl(k, std::false_type{});
+			r.sub(x * (*this));
+			return r;
+		}
+		
+		// x = floor(beta^{k} / this) given r = beta^{k} - x * this, where x is only
+		// off by a few units
+		inline void correctInverse(BigInt &x, BigInt &r) const{
+			while(!r.positive){
+				x -= 1;
+				r.add(*this);
+			}
+			while(r >= *this){
+				x += 1;
+				r.sub(*this);
+			}
+		}
+		
+		// floor(beta^{k} / this) by iterating at the full precision, which may end one
+		// unit below
+		inline BigInt newtonInverseBasecase(SizeT k) const{
 			SizeT lenBin = lenOfBinary();
 			if(k < lenBin){
 				return BigInt();
@@ -3423,14 +4017,339 @@ namespace bignum{
 			return std::move(x[i & 1]);
 		}
 		
+		// (floor(sqrt(this)), this - floor(sqrt(this)) ^ 2)
+		// 
+		// the product of the top bits of this by the reciprocal square root from
+		// newtonInverseSqrt() is within a few units of the root, which the remainder
+		// then corrects.
+		inline std::pair<BigInt, BigInt> sqrtRem() const{
+			constexpr SizeT GUARD = ENTRY_SIZE;
+			
+			if(!positive){
+				throw std::domain_error("square root of a negative number");
+				// errno = EDOM;
+			}
+			
+			SizeT lenBin = lenOfBinary();
+			BigInt s;
+			if(lenBin <= 4 * GUARD){
+				s = sqrtBasecase();
+			}
+			else{
+				// h bits of the root, from a reciprocal square root of h + GUARD bits and
+				// the top h + GUARD bits of this
+				SizeT h = (lenBin + 1) / 2;
+				SizeT k = 2 * h + GUARD;
+				BigInt y = newtonInverseSqrt(k);
+				SizeT j = lenBin - h - GUARD;
+				s = *this >> j;
+				s.multiplyShr(y, k - j);
+			}
+			
+			BigInt r = *this;
+			BigInt sq = s;
+			sq.square();
+			r.sub(sq);
+			while(!r.positive){
+				s -= 1;
+				r += (s << 1) + 1;
+			}
+			while(r > (s << 1)){
+				r -= (s << 1) + 1;
+				s += 1;
+			}
+			return std::make_pair(std::move(s), std::move(r));
+		}
+		
+		// floor(sqrt(this)) by Heron's iteration x = (x + this / x) / 2, which
+		// decreases from 2^{ceil(lenBin / 2)} until it stops at the root. For short
+		// numbers only.
+		inline BigInt sqrtBasecase() const{
+			if(isZero()){
+				return BigInt();
+			}
+			BigInt x = static_cast<BigInt>(1);
+			x.shl((lenOfBinary() + 1) / 2, std::false_type{});
+			while(true){
+				BigInt y = *this / x;
+				y.add(x);
+				y.shr(1u, std::false_type{});
+				if(y >= x){
+					return x;
+				}
+				x = std::move(y);
+			}
+		}
+		
+		// about beta^{k} / sqrt(this) for this > 0 and 2k > lenBin, off by a few units
+		// at most, with beta = 2 as in newtonInverse()
+		// 
+		// the m = k - ceil(lenBin / 2) bits of the result only depend on the top
+		// m + GUARD bits of this, so a longer this is truncated by an even number of
+		// bits first. The result at half the precision is then found recursively, and
+		// a single Newton step y += y * (1 - this * y ^ 2 / beta^{2k}) / 2 at the full
+		// precision doubles its correct bits. Short results are taken from the
+		// square root of beta^{2k} / this.
+		inline BigInt newtonInverseSqrt(SizeT k) const{
+			constexpr SizeT GUARD = ENTRY_SIZE;
+			
+			SizeT lenBin = lenOfBinary();
+			SizeT m = k - (lenBin + 1) / 2;
+			if(lenBin > m + 2 * GUARD){
+				SizeT s = (lenBin - m - GUARD) / 2;
+				return (*this >> (2 * s)).newtonInverseSqrt(k - s);
+			}
+			if(m <= 4 * GUARD){
+				BigInt p = static_cast<BigInt>(1);
+				p.shl(2 * k, std::false_type{});
+				return (p / *this).sqrtBasecase();
+			}
+			
+			// x = y * beta^{t} approximates beta^{k} / sqrt(this) to about m - t bits
+			SizeT t = (m - GUARD) / 2;
+			BigInt y = newtonInverseSqrt(k - t);
+			
+			// e = beta^{2(k - t)} - this * y ^ 2, so that beta^{2k} - this * x ^ 2 is
+			// e * beta^{2t} and the step adds x * e * beta^{2t} / beta^{2k + 1}. Only the
+			// top bits of e matter.
+			BigInt e = static_cast<BigInt>(1);
+			e.shl(2 * (k - t), std::false_type{});
+			BigInt sq = y;
+			sq.square();
+			e.sub(sq * (*this));
+			
+			SizeT sh = 2 * k + 1 - 3 * t;
+			SizeT lenE = e.lenOfBinary();
+			SizeT u = (lenE > t + GUARD)? (lenE - t - GUARD): 0;
+			if(u > sh){
+				u = sh;
+			}
+			BigInt delta = e >> u;
+			delta.multiplyShr(y, sh - u);
+			
+			BigInt x = std::move(y);
+			x.shl(t, std::false_type{});
+			x.add(delta);
+			return x;
+		}
+		
+		// floor(this ^ {1 / k}) for this > 0 and 1 < k < lenBin
+		// 
+		// Newton's iteration x = ((k - 1) * x + this / x ^ {k - 1}) / k decreases
+		// from any x above the root until it stops at the root, and converges fast
+		// once x is above by less than a 1 / k fraction. The start is one more than
+		// the root of this >> (k * h), shifted by h, which has about half of the bits
+		// right, or a floating point estimate raised by its rounding error for short
+		// roots.
+		inline BigInt rootBy(SizeT k) const{
+			constexpr SizeT GUARD = ENTRY_SIZE;
+			
+			if(2 == k){
+				return sqrtRem().first;
+			}
+			
+			SizeT lenBin = lenOfBinary();
+			SizeT b = (lenBin + k - 1) / k;
+			BigInt x;
+			if(b > 2 * GUARD){
+				SizeT h = b / 2;
+				x = (*this >> (std::uintmax_t(k) * h)).rootBy(k);
+				x += 1;
+				x.shl(h, std::false_type{});
+			}
+			else{
+				// 2^{lg} for lg = log2(this) / k from the top digit of this, where lg is
+				// off by about lenBin * 2^{-53} / k
+				SizeT low = (lenBin > ENTRY_SIZE)? (lenBin - ENTRY_SIZE): 0;
+				BigInt top = *this >> low;
+				double lg = (std::log2(static_cast<double>(top.buf.data[0])) + static_cast<double>(low)) / static_cast<double>(k);
+				lg += std::ldexp(static_cast<double>(lenBin), -50) / static_cast<double>(k) + std::ldexp(1.0, -40);
+				SizeT ip = static_cast<SizeT>(lg);
+				x = static_cast<BigInt>(static_cast<Ele>(std::exp2(lg - static_cast<double>(ip) + 52.0)));
+				if(ip >= 52){
+					x.shl(ip - 52, std::false_type{});
+				}
+				else{
+					x.shr(52 - ip, std::false_type{});
+				}
+				x += 1;
+			}
+			
+			while(true){
+				BigInt y = x;
+				y *= k - 1;
+				y += *this / pow(x, k - 1);
+				y /= k;
+				if(y >= x){
+					return x;
+				}
+				x = std::move(y);
+			}
+		}
+		
+		// whether this > 1 is a p-th power for an odd prime p dividing v, the
+		// multiplicity of one of its prime factors
+		inline bool isOddPowerDividing(SizeT v) const{
+			for(;0 == (v & 1);v >>= 1){}
+			for(SizeT p = 3;p <= v;p += 2){
+				if(0 != v % p){
+					continue;
+				}
+				for(;0 == v % p;v /= p){}
+				if(maybePower(p) && (pow(rootBy(p), p) == *this)){
+					return true;
+				}
+			}
+			return false;
+		}
+		
+		// the multiplicity of the prime s in this > 0. this is divided by s, s^2,
+		// s^4, ... as long as they divide it, and then by the same powers downwards,
+		// so it takes about 2 log2 of the multiplicity divisions.
+		inline SizeT multiplicity(Ele s) const{
+			SizeT v(0);
+			BigInt m = *this;
+			std::vector<BigInt> powers(1, BigInt(s));
+			for(;;){
+				std::pair<BigInt, BigInt> qr = divmod(m, powers.back());
+				if(!qr.second.isZero()){
+					break;
+				}
+				m = std::move(qr.first);
+				v += SizeT(1) << (powers.size() - 1);
+				powers.push_back(powers.back() * powers.back());
+			}
+			powers.pop_back();
+			for(std::size_t i = powers.size();i-- > 0;){
+				std::pair<BigInt, BigInt> qr = divmod(m, powers[i]);
+				if(qr.second.isZero()){
+					m = std::move(qr.first);
+					v += SizeT(1) << i;
+				}
+			}
+			return v;
+		}
+		
+		// false if this > 0 is surely not a p-th power for an odd prime p, by its
+		// residue modulo the first prime q = 1 (mod p)
+		inline bool maybePower(SizeT p) const{
+			Ele q = powerModulus(p, 1);
+			return isPowerResidue(*this % q, p, q);
+		}
+		
+		// the first prime q = 1 (mod p) above after
+		inline static Ele powerModulus(SizeT p, Ele after){
+			auto isPrime = [](Ele n){
+				for(Ele d = 3;d * d <= n;d += 2){
+					if(0 == n % d){
+						return false;
+					}
+				}
+				return true;
+			};
+			Ele q = after + 2 * Ele(p) - (after - 1) % (2 * Ele(p));
+			for(;!isPrime(q);q += 2 * Ele(p)){}
+			return q;
+		}
+		// whether r is a p-th power modulo a prime q = 1 (mod p): those are 0 and the
+		// (q - 1) / p residues r with r ^ {(q - 1) / p} = 1
+		inline static bool isPowerResidue(Ele r, SizeT p, Ele q){
+			if(Ele(0) == r){
+				return true;
+			}
+			Ele res(1);
+			for(Ele e = (q - 1) / p;e > 0;e >>= 1){
+				Ele high;
+				if(Ele(0) != (e & Ele(1))){
+					Ele low = _utility::mulFull(res, r, high);
+					_utility::divFull(high, low, q, res);
+				}
+				Ele low = _utility::mulFull(r, r, high);
+				_utility::divFull(high, low, q, r);
+			}
+			return Ele(1) == res;
+		}
+		
+		// composite[d] is set for the odd composites d < n
+		inline static std::vector<char> oddComposites(SizeT n){
+			std::vector<char> composite(n, 0);
+			for(SizeT d = 3;std::uintmax_t(d) * d < n;d += 2){
+				if(0 != composite[d]){
+					continue;
+				}
+				for(std::uintmax_t j = std::uintmax_t(d) * d;j < n;j += 2 * d){
+					composite[static_cast<SizeT>(j)] = 1;
+				}
+			}
+			return composite;
+		}
+		
+		// this mod moduli[i] for every i, for this >= 0. A remainder tree reduces
+		// this by the product of each half of the moduli before going down to it,
+		// which costs a few divisions per level in place of one pass over this per
+		// modulus.
+		inline std::vector<Ele> residues(const std::vector<Ele> &moduli) const{
+			std::vector<Ele> res(moduli.size());
+			if(moduli.empty()){
+				return res;
+			}
+			std::vector<BigInt> tree(4 * moduli.size());
+			productTree(tree, 1, moduli, 0, moduli.size());
+			remainderTree(*this % tree[1], tree, 1, moduli, 0, moduli.size(), res);
+			return res;
+		}
+		// moduli per leaf of a remainder tree, whose products are a few digits
+		static constexpr std::size_t RESIDUE_LEAF = 8;
+		
+		// tree[node] = the product of moduli[first, last). Node i has the children 2i
+		// and 2i + 1, down to leaves of at most RESIDUE_LEAF moduli.
+		inline static void productTree(std::vector<BigInt> &tree, std::size_t node, 
+			const std::vector<Ele> &moduli, std::size_t first, std::size_t last){
+			if(last - first <= RESIDUE_LEAF){
+				tree[node] = BigInt(Ele(1));
+				for(std::size_t i = first;i < last;++i){
+					tree[node] *= moduli[i];
+				}
+				return ;
+			}
+			std::size_t mid = first + (last - first) / 2;
+			productTree(tree, 2 * node, moduli, first, mid);
+			productTree(tree, 2 * node + 1, moduli, mid, last);
+			tree[node] = tree[2 * node] * tree[2 * node + 1];
+		}
+		// res[i] = r mod moduli[i] for first <= i < last, r being reduced modulo
+		// tree[node]
+		inline static void remainderTree(const BigInt &r, const std::vector<BigInt> &tree, std::size_t node, 
+			const std::vector<Ele> &moduli, std::size_t first, std::size_t last, std::vector<Ele> &res){
+			if(last - first <= RESIDUE_LEAF){
+				for(std::size_t i = first;i < last;++i){
+					res[i] = r % moduli[i];
+				}
+				return ;
+			}
+			std::size_t mid = first + (last - first) / 2;
+			remainderTree(r % tree[2 * node], tree, 2 * node, moduli, first, mid, res);
+			remainderTree(r % tree[2 * node + 1], tree, 2 * node + 1, moduli, mid, last, res);
+		}
+		
+		// bit i of the result is set if i is a square modulo q, for q <= 64
+		static constexpr Ele squareResidues(Ele q){
+			Ele mask(0);
+			for(Ele i = 0;i < q;++i){
+				mask |= Ele(1) << (i * i % q);
+			}
+			return mask;
+		}
+		
 		// assumes this and _rhs is positive
 		// returns std::pair(Q, R)
 		// for two non-negative integer a, b such that miu - a <
-		// beta^{k} / _rhs < miu + b, Barret reduction iterates at most
+		// beta^{2n} / _rhs (n = _rhs.buf.len) < miu + b, Barret reduction iterates at most
 		// max(a + 2, b + 1) times to return the corret result
 		template <class BigIntRef2, 
 			typename std::enable_if<isRLRef<BigInt, BigIntRef2 &&>::value>::type * = nullptr>
-		inline std::pair<BigInt, BigInt> barretReduction(const BigInt &_rhs, BigIntRef2 &&miu) &&{
+		inline std::pair<BigInt, BigInt> barretReduction(const BigInt &_rhs, BigIntRef2 &&miu, 
+			TransformCache *rhsCache = nullptr, TransformCache *miuCache = nullptr) &&{
 			assert(_rhs.buf.len > 0);
 			assert(buf.len >= _rhs.buf.len);
 			assert(_rhs.buf.len * 2 >= buf.len);
@@ -3465,7 +4384,7 @@ namespace bignum{
 			
 			std::pair<BigInt, BigInt> res;
 			res.first = truncateFrom(*this, _rhs.buf.len - 1);
-			res.first.multiplyTruncate(std::forward<BigIntRef2>(miu), buf.len - _rhs.buf.len + 1);
+			res.first.multiplyTruncate(std::forward<BigIntRef2>(miu), _rhs.buf.len + 1, miuCache);
 #ifdef _BIG_NUM_DEBUG_
 				/*std::cout << std::endl << "q * _rhs:\t" << std::endl;
 				(_rhs * res.first).output(std::cout);
@@ -3476,7 +4395,7 @@ namespace bignum{
 				assert(!isZero());
 				res.second.positive = true;
 			}
-			res.second.sub(_rhs * res.first);
+			res.second.subMultiply(res.first, _rhs, _rhs.buf.len + 1, rhsCache);
 #ifdef _BIG_NUM_DEBUG_
 				/*std::cout << std::endl << "r:\t" << std::endl;
 				res.second.output(std::cout);
@@ -3510,20 +4429,21 @@ namespace bignum{
 		}
 		template <class BigIntRef2, 
 			typename std::enable_if<isRLRef<BigInt, BigIntRef2 &&>::value>::type * = nullptr>
-		inline std::pair<BigInt, BigInt> barretReduction(const BigInt &_rhs, BigIntRef2 &&miu) const &{
+		inline std::pair<BigInt, BigInt> barretReduction(const BigInt &_rhs, BigIntRef2 &&miu, 
+			TransformCache *rhsCache = nullptr, TransformCache *miuCache = nullptr) const &{
 			assert(_rhs.buf.len > 0);
 			assert(buf.len >= _rhs.buf.len);
 			assert(_rhs.buf.len * 2 >= buf.len);
 			
 			std::pair<BigInt, BigInt> res;
 			res.first = truncateFrom(*this, _rhs.buf.len - 1);
-			res.first.multiplyTruncate(std::forward<BigIntRef2>(miu), buf.len - _rhs.buf.len + 1);
+			res.first.multiplyTruncate(std::forward<BigIntRef2>(miu), _rhs.buf.len + 1, miuCache);
 			res.second = *this;
 			if(res.second.positive){
 				assert(!isZero());
 				res.second.positive = true;
 			}
-			res.second.sub(_rhs * res.first);
+			res.second.subMultiply(res.first, _rhs, _rhs.buf.len + 1, rhsCache);
 			do{
 				if(!res.second.positive){
 					res.second += _rhs;
@@ -3542,20 +4462,21 @@ namespace bignum{
 		}
 		template <class BigIntRef2, 
 			typename std::enable_if<isRLRef<BigInt, BigIntRef2 &&>::value>::type * = nullptr>
-		inline BigInt barretResident(const BigInt &_rhs, BigIntRef2 &&miu) &&{
+		inline BigInt barretResident(const BigInt &_rhs, BigIntRef2 &&miu, 
+			TransformCache *rhsCache = nullptr, TransformCache *miuCache = nullptr) &&{
 			assert(_rhs.buf.len > 0);
 			assert(buf.len >= _rhs.buf.len);
 			assert(_rhs.buf.len * 2 >= buf.len);
 			
 			BigInt Q, res;
 			Q = truncateFrom(*this, _rhs.buf.len - 1);
-			Q.multiplyTruncate(std::forward<BigIntRef2>(miu), buf.len - _rhs.buf.len + 1);
+			Q.multiplyTruncate(std::forward<BigIntRef2>(miu), _rhs.buf.len + 1, miuCache);
 			res = std::move(*this);
 			if(!res.positive){
 				assert(!isZero());
 				res.positive = true;
 			}
-			res.sub(_rhs * Q);
+			res.subMultiply(Q, _rhs, _rhs.buf.len + 1, rhsCache);
 			do{
 				if(!res.positive){
 					res += _rhs;
@@ -3572,20 +4493,21 @@ namespace bignum{
 		}
 		template <class BigIntRef2, 
 			typename std::enable_if<isRLRef<BigInt, BigIntRef2 &&>::value>::type * = nullptr>
-		inline BigInt barretResident(const BigInt &_rhs, BigIntRef2 &&miu) const &{
+		inline BigInt barretResident(const BigInt &_rhs, BigIntRef2 &&miu, 
+			TransformCache *rhsCache = nullptr, TransformCache *miuCache = nullptr) const &{
 			assert(_rhs.buf.len > 0);
 			assert(buf.len >= _rhs.buf.len);
 			assert(_rhs.buf.len * 2 >= buf.len);
 			
 			BigInt Q, res;
 			Q = truncateFrom(*this, _rhs.buf.len - 1);
-			Q.multiplyTruncate(std::forward<BigIntRef2>(miu), buf.len - _rhs.buf.len + 1);
+			Q.multiplyTruncate(std::forward<BigIntRef2>(miu), _rhs.buf.len + 1, miuCache);
 			res = std::move(*this);
 			if(!res.positive){
 				assert(!isZero());
 				res.positive = true;
 			}
-			res.sub(_rhs * Q);
+			res.subMultiply(Q, _rhs, _rhs.buf.len + 1, rhsCache);
 			do{
 				if(!res.positive){
 					res += _rhs;
@@ -3601,8 +4523,232 @@ namespace bignum{
 			return res;
 		}
 		
+		// Burnikel-Ziegler division beats computing a reciprocal for Barrett reduction
+		// below the threshold
+		inline static bool useRecursiveDivision(const BigInt &_rhs) noexcept{
+			SizeT threshold = (_utility::simdLanes32() != 0)? SizeT(_BIG_NUM_DIV_BARRETT_THRESHOLD_): SizeT(_BIG_NUM_DIV_BARRETT_SCALAR_THRESHOLD_);
+			return (_rhs.buf.len >= 2) && (_rhs.buf.len < threshold);
+		}
+		
+		// res[0, xLen + yLen) = x * y by whichever algorithm fits the sizes
+		inline void multiplyDigitsFull(Ele *res, const Ele *x, SizeT xLen, const Ele *y, SizeT yLen){
+			if(std::min(xLen, yLen) < nttThreshold()){
+				multiplyDigitsAny(res, x, xLen, y, yLen);
+			}
+			else{
+				std::fill(res, res + (xLen + yLen), Ele(0));
+				multiplyDigits(res, xLen + yLen, x, xLen, y, yLen);
+			}
+		}
+		// res[0, 2xLen) = x ^ 2 likewise. NTT products detect the aliased operands
+		// themselves and do a single forward transform.
+		inline void squareDigitsFull(Ele *res, const Ele *x, SizeT xLen){
+			if(xLen < nttThreshold()){
+				squareDigitsAny(res, x, xLen);
+			}
+			else{
+				std::fill(res, res + 2 * xLen, Ele(0));
+				multiplyDigits(res, 2 * xLen, x, xLen, x, xLen);
+			}
+		}
+		
+		// schoolbook division (Knuth's algorithm D) of a[0, aLen) by d[0, n), whose top
+		// digit has the highest bit set. q[0, aLen - n) gets the quotient, except for
+		// its digit at aLen - n which is returned (0 or 1), and the remainder is left in
+		// a[0, n).
+		// 
+		// Quotient digits are estimated by multiplying with the reciprocal of the top
+		// digit of d instead of dividing by it.
+		inline static Ele divideDigitsBasecase(Ele *q, Ele *a, SizeT aLen, const Ele *d, SizeT n) noexcept{
+			assert(aLen >= n);
+			assert(Ele(0) != (d[n - 1] >> (ENTRY_SIZE - 1)));
+			
+			Ele qh(0);
+			if(_utility::compareDigits(a + (aLen - n), d, n) >= 0){
+				_utility::subDigits(a + (aLen - n), a + (aLen - n), d, n);
+				qh = Ele(1);
+			}
+			
+			Ele d1 = d[n - 1];
+			Ele v = _utility::reciprocalWord(d1);
+			if(1 == n){
+				for(SizeT j = aLen - 1;j > 0;--j){
+					q[j - 1] = _utility::divFullPreinv(a[j], a[j - 1], d1, v, a[j - 1]);
+					a[j] = Ele(0);
+				}
+				return qh;
+			}
+			
+			Ele d0 = d[n - 2];
+			for(SizeT j = aLen - n;j > 0;--j){
+				// a[j - 1, j + n) < d * beta, so the top digit is at most d1
+				Ele *cur = a + (j - 1);
+				Ele n2 = cur[n], n1 = cur[n - 1], n0 = cur[n - 2];
+				
+				// qhat from the top two digits of d is at most 2 too large
+				Ele qhat, rhat;
+				bool rOver;
+				if(n2 >= d1){
+					qhat = ~Ele(0);
+					rhat = n1 + d1;
+					rOver = (rhat < n1);
+				}
+				else{
+					qhat = _utility::divFullPreinv(n2, n1, d1, v, rhat);
+					rOver = false;
+				}
+				while(!rOver){
+					Ele high;
+					Ele low = _utility::mulFull(qhat, d0, high);
+					if((high < rhat) || ((high == rhat) && (low <= n0))){
+						break;
+					}
+					--qhat;
+					rhat += d1;
+					rOver = (rhat < d1);
+				}
+				
+				Ele borrow = _utility::subMulDigit(cur, d, n, qhat);
+				if(n2 < borrow){
+					// qhat was still one too large
+					--qhat;
+					_utility::addDigits(cur, cur, d, n);
+				}
+				cur[n] = Ele(0);
+				q[j - 1] = qhat;
+			}
+			return qh;
+		}
+		
+		// Burnikel-Ziegler division of a[0, n + k) by a normalized d[0, n) for k <= n.
+		// q[0, k) gets the quotient but its digit at k, which is returned, and the
+		// remainder is left in a[0, n).
+		// 
+		// The quotient is first estimated by dividing the top 2k digits of a by the
+		// top k digits of d recursively. Subtracting the estimate times the other
+		// n - k digits of d leaves a remainder that is at most 2 multiples of d below
+		// zero.
+		inline Ele divideDigitsTop(Ele *q, Ele *a, const Ele *d, SizeT n, SizeT k){
+			assert(k <= n);
+			
+			if(k < _BIG_NUM_DIV_DC_THRESHOLD_){
+				return divideDigitsBasecase(q, a, n + k, d, n);
+			}
+			
+			Ele qh = divideDigitsBalanced(q, a + (n - k), d + (n - k), k);
+			if(k < n){
+				SizeT m = n - k;
+				EleBuffer prod(n, Ele(0), allocator);
+				multiplyDigitsFull(prod.data(), q, k, d, m);
+				Ele borrow = _utility::subDigits(a, a, prod.data(), n);
+				if(Ele(0) != qh){
+					borrow += _utility::subDigits(a + k, a + k, d, m);
+				}
+				while(Ele(0) != borrow){
+					qh -= _utility::subDigit(q, q, k, Ele(1));
+					borrow -= _utility::addDigits(a, a, d, n);
+				}
+			}
+			return qh;
+		}
+		
+		// the same as divideDigitsTop for a[0, 2n), done as two divisions whose
+		// quotients are half as long
+		inline Ele divideDigitsBalanced(Ele *q, Ele *a, const Ele *d, SizeT n){
+			if(n < _BIG_NUM_DIV_DC_THRESHOLD_){
+				return divideDigitsBasecase(q, a, 2 * n, d, n);
+			}
+			
+			SizeT lo = n / 2, hi = n - lo;
+			Ele qh = divideDigitsTop(q + lo, a + lo, d, n, hi);
+			// the remainder of the high half is less than d
+			Ele ql = divideDigitsTop(q, a, d, n, lo);
+			assert(Ele(0) == ql);
+			(void)ql;
+			return qh;
+		}
+		
+		// assume this and _rhs are non-negative, with this not shorter than _rhs,
+		// which has at least 2 digits. dNorm may give the digits of _rhs already
+		// shifted as below.
+		// 
+		// no reciprocal is needed: the dividend is cut into blocks of the length of
+		// _rhs from the top, and every block is divided by Burnikel-Ziegler recursion
+		// whose leaves are schoolbook divisions.
+		inline std::pair<BigInt, BigInt> divideByRecursive(const BigInt &_rhs, const Ele *dNorm = nullptr) &&{
+			assert(buf.len >= _rhs.buf.len);
+			assert(_rhs.buf.len >= 2);
+			
+			SizeT n = _rhs.buf.len;
+			SizeT aLen = buf.len + 1;
+			
+			// shifts both operands so that the top bit of the divisor is set. The top
+			// n digits of the dividend are then less than the divisor.
+			int shift = _utility::countLeadingZero(_rhs.buf.data[n - 1]);
+			EleBuffer d(allocator);
+			if(nullptr == dNorm){
+				d.assign(_rhs.buf.data, _rhs.buf.data + n);
+				if(0 != shift){
+					_utility::shlDigits(d.data(), d.data(), n, shift);
+				}
+				dNorm = d.data();
+			}
+			EleBuffer a(aLen, Ele(0), allocator);
+			if(0 != shift){
+				a[buf.len] = _utility::shlDigits(a.data(), buf.data, buf.len, shift);
+			}
+			else{
+				std::copy(buf.data, buf.data + buf.len, a.data());
+			}
+			
+			SizeT qLen = aLen - n;
+			DigitBuffer _buf(&allocator, qLen);
+			constructZeroDigits(_buf);
+			try{
+				if(n < _BIG_NUM_DIV_DC_THRESHOLD_){
+					// short divisors are divided in a single schoolbook pass
+					Ele qh = divideDigitsBasecase(_buf.data, a.data(), aLen, dNorm, n);
+					assert(Ele(0) == qh);
+					(void)qh;
+				}
+				else{
+					for(SizeT st = qLen;st > 0;){
+						SizeT k = (0 == st % n)? n: (st % n);
+						st -= k;
+						Ele qh = divideDigitsTop(_buf.data + st, a.data() + st, dNorm, n, k);
+						assert(Ele(0) == qh);
+						(void)qh;
+					}
+				}
+			}
+			catch(...){
+				releaseDigits(_buf);
+				throw ;
+			}
+			
+			std::pair<BigInt, BigInt> res;
+			res.first.takeDigits(_buf);
+			res.first.buf.shrinkToFit();
+			
+			// the remainder takes the digits of this
+			if(0 != shift){
+				_utility::shrDigits(buf.data, a.data(), n, shift);
+			}
+			else{
+				std::copy(a.data(), a.data() + n, buf.data);
+			}
+			buf.resize(n);
+			buf.shrinkToFit();
+			positive = true;
+			res.second = std::move(*this);
+			return res;
+		}
+		inline std::pair<BigInt, BigInt> divideByRecursive(const BigInt &_rhs, const Ele *dNorm = nullptr) const &{
+			return BigInt(*this).divideByRecursive(_rhs, dNorm);
+		}
+		
 		// assume this and _rhs are non-negative.
-		inline std::pair<BigInt, BigInt> divideByMedium(const BigInt &_rhs) &&{
+		inline std::pair<BigInt, BigInt> divideByMedium(const BigInt &_rhs, const DivisorHint *hint = nullptr) &&{
 			//assert(positive);
 			//assert(_rhs.positive);
 			
@@ -3618,11 +4764,18 @@ namespace bignum{
 			assert(buf.len >= _rhs.buf.len);
 			assert(buf.len <= _rhs.buf.len * 2);
 			
+			if(useRecursiveDivision(_rhs)){
+				return std::move(*this).divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm);
+			}
+			if(nullptr != hint){
+				assert(nullptr != hint->miu);
+				return std::move(*this).barretReduction(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
+			}
 			//SizeT lenBin = lenOfBinary();
 			//return std::move(*this).barretReduction(_rhs, _rhs.newtonInverse(lenBin));
-			return std::move(*this).barretReduction(_rhs, _rhs.newtonInverse(buf.len * ENTRY_SIZE));
+			return std::move(*this).barretReduction(_rhs, _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE));
 		}
-		inline std::pair<BigInt, BigInt> divideByMedium(const BigInt &_rhs) const &{
+		inline std::pair<BigInt, BigInt> divideByMedium(const BigInt &_rhs, const DivisorHint *hint = nullptr) const &{
 			//assert(positive);
 			//assert(_rhs.positive);
 			
@@ -3639,12 +4792,20 @@ namespace bignum{
 			assert(buf.len >= _rhs.buf.len);
 			assert(buf.len <= _rhs.buf.len * 2);
 			
+			if(useRecursiveDivision(_rhs)){
+				return divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm);
+			}
+			if(nullptr != hint){
+				assert(nullptr != hint->miu);
+				return barretReduction(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
+			}
 			//SizeT lenBin = lenOfBinary();
 			//return barretReduction(_rhs, _rhs.newtonInverse(lenBin));
-			return barretReduction(_rhs, _rhs.newtonInverse(buf.len * ENTRY_SIZE));
+			return barretReduction(_rhs, _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE));
 		}
 		
-		inline std::pair<BigInt, BigInt> divideBy(const BigInt &_rhs) &&{
+		// hint, if given, is what a Divisor keeps of _rhs
+		inline std::pair<BigInt, BigInt> divideBy(const BigInt &_rhs, const DivisorHint *hint = nullptr) &&{
 			//assert(positive);
 			//assert(_rhs.positive);
 			if(_rhs.isZero()){
@@ -3659,402 +4820,402 @@ namespace bignum{
 			if(buf.len < _rhs.buf.len){
 				return std::make_pair(BigInt(0), std::move(*this));
 			}
+			if(1 == _rhs.buf.len){
+				std::pair<BigInt, Ele> qr = std::move(*this).divideByUnsigned(_rhs.buf.data[0], std::true_type{});
+				return std::pair<BigInt, BigInt>(std::move(qr.first), BigInt(qr.second));
+			}
+			if(useRecursiveDivision(_rhs)){
+				return std::move(*this).divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm);
+			}
 			
 			if(buf.len <= _rhs.buf.len * 2){
 				try{
-					return std::move(*this).divideByMedium(_rhs);
+					return std::move(*this).divideByMedium(_rhs, hint);
 				}
 				catch(std::domain_error &){
 					assert(false);
 				}
 			}
 			
-			std::pair<BigInt, BigInt> res;
-			// TODO: avoid unnecessary memory allocation
-			BigInt miu = _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE);
-			SizeT L = buf.len;
-			SizeT finish = 0;
+			// schoolbook division with _rhs.buf.len digits of this at a time. Every
+			// step divides a number less than _rhs * beta^{n} thus at most 2n digits
+			// long, which is what barretReduction accepts.
+			SizeT n = _rhs.buf.len;
+			// every block multiplies by the same _rhs and miu
+			BigInt miu;
+			TransformCache rhsCache, miuCache;
+			DivisorHint local{nullptr, &miu, &rhsCache, &miuCache};
+			if(nullptr == hint){
+				// TODO: avoid unnecessary memory allocation
+				miu = _rhs.newtonInverse(2 * n * ENTRY_SIZE);
+				hint = &local;
+			}
 			
-			{
-				// I am looking forward to P1044R1 merged into offical C++ standard
-				std::pair<BigInt, BigInt> qr = subStr(buf.len - 2 * _rhs.buf.len, buf.len).barretReduction(_rhs, miu);
-				
-				destroyAll(res.first.buf.data, res.first.buf.data + res.first.buf.len, res.first.allocator);
-				res.first.allocator.deallocate(res.first.buf.data, static_cast<std::size_t>(res.first.buf.cap));
-				res.first.buf.setLen(buf.len - 2 * _rhs.buf.len + qr.first.buf.len);
-				res.first.buf.data = res.first.allocator.allocate(static_cast<std::size_t>(res.first.buf.cap));
-				
-				SizeT i = buf.len - 2 * _rhs.buf.len;
-				try{
-					for(;i < buf.len - 2 * _rhs.buf.len + qr.first.buf.len;++i){
-						res.first.allocator.construct(res.first.buf.data + i, std::move(qr.first.buf.data[i - (buf.len - 2 * _rhs.buf.len)]));
+			std::pair<BigInt, BigInt> res;
+			DigitBuffer _buf(&allocator, buf.len);
+			constructZeroDigits(_buf);
+			try{
+				for(SizeT st = (buf.len - 1) / n * n;true;st -= n){
+					BigInt cur = subStr(st, st + n);
+					cur.buf.shrinkToFit();
+					if(!res.second.isZero()){
+						res.second.shl(n * ENTRY_SIZE, std::false_type{});
+						cur.add(std::move(res.second));
 					}
-				}
-				catch(...){
-					destroyAll(res.first.buf.data + (buf.len - 2 * _rhs.buf.len), res.first.buf.data + i, res.first.allocator);
-					res.first.allocator.deallocate(res.first.buf.data, static_cast<std::size_t>(res.first.buf.cap));
-					res.first.buf.data = nullptr;
-					res.first.buf.zeroLen();
 					
-					throw ;
-				}
-				finish = buf.len - 2 * _rhs.buf.len;
-				
-				if(qr.second.isZero()){
-					/*for(i = buf.len - 2 * _rhs.buf.len;i < buf.len;++i){
-						buf.data[i] = 0;
-					}*/
-					destroyAll(buf.data + (buf.len - 2 * _rhs.buf.len), buf.data + buf.len, allocator);
-					L -= 2 * _rhs.buf.len;
-				}
-				else{
-					for(i = 0;i < qr.second.buf.len;++i){
-						buf.data[buf.len - 2 * _rhs.buf.len + i] = std::move(qr.second.buf.data[i]);
+					if(cur < _rhs){
+						res.second = std::move(cur);
+					}
+					else{
+						BigInt q;
+						std::tie(q, res.second) = std::move(cur).barretReduction(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
+						assert(q.buf.len <= n);
+						std::copy(q.buf.data, q.buf.data + q.buf.len, _buf.data + st);
+					}
+					
+					if(0 == st){
+						break;
 					}
-					destroyAll(buf.data + (buf.len - 2 * _rhs.buf.len + qr.second.buf.len), buf.data + buf.len, allocator);
-					/*for(i = buf.len - 2 * _rhs.buf.len + qr.second.buf.len;i < buf.len;++i){
-						buf.data[i] = 0;
-					}*/
-					L -= 2 * _rhs.buf.len - qr.second.buf.len;
 				}
 			}
+			catch(...){
+				releaseDigits(_buf);
+				throw ;
+			}
 			
-			_BIG_NUM_ADD_FINALIZER_CODE_(
-				destroyAll(buf.data, buf.data + L, allocator);
-				allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-				buf.data = nullptr;
-				buf.zeroLen();
-			);
+			res.first.takeDigits(_buf);
+			res.first.buf.shrinkToFit();
+			return res;
+		}
+		inline std::pair<BigInt, BigInt> divideBy(const BigInt &_rhs, const DivisorHint *hint = nullptr) const &{
+			//assert(positive);
+			//assert(_rhs.positive);
 			
-			while(L >= 2 * _rhs.buf.len){
-				std::pair<BigInt, BigInt> qr = subStr(L - 2 * _rhs.buf.len, L).barretReduction(_rhs, miu);
-				
-				SizeT i = L - 2 * _rhs.buf.len;
-				assert(i + qr.first.buf.len <= finish);
-				try{
-					for(;i < L - 2 * _rhs.buf.len + qr.first.buf.len;++i){
-						res.first.allocator.construct(res.first.buf.data + i, std::move(qr.first.buf.data[i - (L - 2 * _rhs.buf.len)]));
-					}
-					for(i = L - 2 * _rhs.buf.len + qr.first.buf.len;i < finish;++i){
-						res.first.allocator.construct(res.first.buf.data + i, Ele(0));
-					}
+			return BigInt(*this).divideBy(_rhs, hint);
+		}
+		
+		// window width for exponents of the given number of bits, so that the 2^{k-1}
+		// precomputed odd powers pay off in the multiplications saved
+		inline static LogSizeT powWindowSize(SizeT bits) noexcept{
+			static constexpr SizeT limits[] = {24, 80, 240, 672, 1792, 4608};
+			LogSizeT k = 1;
+			for(SizeT limit: limits){
+				if(bits <= limit){
+					break;
 				}
-				catch(...){
-					destroyAll(res.first.buf.data + L - 2 * _rhs.buf.len, res.first.buf.data + i, res.first.allocator);
-					destroyAll(res.first.buf.data + finish, res.first.buf.data + res.first.buf.len, res.first.allocator);
-					res.first.allocator.deallocate(res.first.buf.data, static_cast<std::size_t>(res.first.buf.cap));
-					res.first.buf.data = nullptr;
-					res.first.buf.zeroLen();
-					
-					throw ;
+				++k;
+			}
+			return k;
+		}
+		
+		// left-to-right sliding window scan of a positive _exp. Every window is an odd
+		// number w of at most k bits, and the power is built by init(w / 2) for the
+		// first window, then sqr() for every following bit and mul(w / 2) at the end
+		// of every window.
+		template <class Init, class Sqr, class Mul>
+		inline static void slideWindows(const BigInt &_exp, LogSizeT k, Init init, Sqr sqr, Mul mul){
+			assert(!_exp.isZero());
+			auto bit = [&_exp](SizeT i){
+				return Ele(0) != ((_exp.buf.data[i / ENTRY_SIZE] >> (i % ENTRY_SIZE)) & Ele(1));
+			};
+			
+			bool first = true;
+			for(SizeT i = _exp.lenOfBinary();i > 0;){
+				if(!bit(i - 1)){
+					sqr();
+					--i;
+					continue;
 				}
-				finish = L - 2 * _rhs.buf.len;
 				
-				if(qr.second.isZero()){
-					/*for(i = L - 2 * _rhs.buf.len;i < L;++i){
-						buf.data[i] = 0;
-					}*/
-					destroyAll(buf.data + (L - 2 * _rhs.buf.len), buf.data + L, allocator);
-					L -= 2 * _rhs.buf.len;
+				SizeT j = (i > k)? (i - k): SizeT(0);
+				for(;!bit(j);++j){}
+				SizeT w(0);
+				for(SizeT t = i;t > j;--t){
+					w = (w << 1) | SizeT(bit(t - 1));
+				}
+				
+				if(first){
+					init(w >> 1);
+					first = false;
 				}
 				else{
-					for(i = 0;i < qr.second.buf.len;++i){
-						buf.data[L - 2 * _rhs.buf.len + i] = std::move(qr.second.buf.data[i]);
+					for(SizeT t = j;t < i;++t){
+						sqr();
 					}
-					destroyAll(buf.data + (L - 2 * _rhs.buf.len + qr.second.buf.len), buf.data + L, allocator);
-					/*for(i = L - 2 * _rhs.buf.len + qr.second.buf.len;i < L;++i){
-						buf.data[i] = 0;
-					}*/
-					L -= 2 * _rhs.buf.len - qr.second.buf.len;
-				}
-			}
-			
-			assert(L < 2 * _rhs.buf.len);
-			if(L >= _rhs.buf.len){
-				BigInt q;
-				BigInt tmp = subStr(0, L);
-				SizeT tmpLenBin = tmp.lenOfBinary();
-				std::tie(q, res.second) = std::move(tmp).barretReduction(_rhs, _rhs.newtonInverse(tmpLenBin));
-				assert((q.buf.len <= finish) || ((0 == finish) && (q.isZero())));
-				SizeT i = 0;
-				try{
-					for(;i < q.buf.len;++i){
-						res.first.allocator.construct(res.first.buf.data + i, std::move(q.buf.data[i]));
-					}
-					for(i = q.buf.len;i < finish;++i){
-						res.first.allocator.construct(res.first.buf.data + i, 0);
-					}
-				}
-				catch(...){
-					destroyAll(res.first.buf.data, res.first.buf.data + i, res.first.allocator);
-					destroyAll(res.first.buf.data + finish, res.first.buf.data + res.first.buf.len, res.first.allocator);
-					res.first.allocator.deallocate(res.first.buf.data, static_cast<std::size_t>(res.first.buf.cap));
-					res.first.buf.data = nullptr;
-					res.first.buf.zeroLen();
-					
-					throw ;
+					mul(w >> 1);
 				}
+				i = j;
 			}
-			else{
-				destroyAll(res.second.buf.data, res.second.buf.data + res.second.buf.len, res.second.allocator);
-				res.second.allocator.deallocate(res.second.buf.data, static_cast<std::size_t>(res.second.buf.cap));
-				res.second.buf.setLen(L);
-				res.second.buf.data = res.second.allocator.allocate(static_cast<std::size_t>(res.second.buf.cap));
-				SizeT i(0);
-				try{
-					for(;i < L;++i){
-						res.second.allocator.construct(res.second.buf.data + i, std::move(buf.data[i]));
-					}
-				}
-				catch(...){
-					destroyAll(res.second.buf.data, res.second.buf.data + i, res.second.allocator);
-					res.second.allocator.deallocate(res.second.buf.data, static_cast<std::size_t>(res.second.buf.cap));
-					res.second.buf.data = nullptr;
-					res.second.buf.zeroLen();
-					
-					throw ;
-				}
-				
-				try{
-					for(i = 0;i < finish;++i){
-						res.first.allocator.construct(res.first.buf.data + i, 0);
-					}
-				}
-				catch(...){
-					destroyAll(res.first.buf.data, res.first.buf.data + i, res.first.allocator);
-					destroyAll(res.first.buf.data + finish, res.first.buf.data + res.first.buf.len, res.first.allocator);
-					res.first.buf.data = nullptr;
-					res.first.buf.zeroLen();
-					
-					throw ;
+		}
+		
+		// signed exponents
+		template <typename Integer>
+		inline BigInt powBy(Integer _exp, std::true_type) &&{
+			if(_exp < Integer(0)){
+				throw std::domain_error("negative exponent");
+				// errno = EDOM;
+			}
+			return std::move(*this).powBy(static_cast<typename std::make_unsigned<Integer>::type>(_exp), std::false_type{});
+		}
+		// this ^ _exp by left-to-right binary exponentiation of the odd part of this,
+		// its factors 2 being shifted in at the end. The odd part stays in buf while
+		// the powers alternate between two buffers allocated once, long enough for
+		// the result.
+		template <typename Unsigned>
+		inline BigInt powBy(Unsigned _exp, std::false_type) &&{
+			using Common = typename std::common_type<std::uintmax_t, Unsigned>::type;
+			
+			if(Unsigned(0) == _exp){
+				return BigInt(Ele(1));
+			}
+			if(isZero()){
+				return std::move(*this);
+			}
+			bool _positive = positive || (Unsigned(0) == (_exp & Unsigned(1)));
+			positive = true;
+			
+			SizeT zeroDigits(0);
+			for(;Ele(0) == buf.data[zeroDigits];++zeroDigits){}
+			SizeT twos = zeroDigits * ENTRY_SIZE;
+			for(Ele w = buf.data[zeroDigits];Ele(0) == (w & Ele(1));w >>= 1){
+				++twos;
+			}
+			Common maxBits = Common(MAX_LEN) * ENTRY_SIZE;
+			if((twos > 0) && (Common(_exp) > maxBits / twos)){
+				throw std::out_of_range("BigInt::pow");
+				// errno = ERANGE;
+			}
+			Common shift = Common(twos) * Common(_exp);
+			if(twos > 0){
+				shr(twos, std::false_type{});
+			}
+			
+			SizeT bits = lenOfBinary();
+			if(1 == bits){
+				// a power of 2
+				if(shift > 0){
+					shl(shift, std::false_type{});
 				}
+				positive = _positive;
+				return std::move(*this);
+			}
+			if((Common(_exp) > maxBits / bits) || (Common(bits) * Common(_exp) > maxBits - shift)){
+				throw std::out_of_range("BigInt::pow");
+				// errno = ERANGE;
 			}
 			
+			// x ^ k has at most bits * k bits, and the raw product of two powers whose
+			// exponents add up to at most _exp at most one digit more
+			SizeT L = static_cast<SizeT>((Common(bits) * Common(_exp) + ENTRY_SIZE - 1) / ENTRY_SIZE) + 1;
+			EleBuffer x(L, Ele(0), allocator), y(L, Ele(0), allocator);
+			std::copy(buf.data, buf.data + buf.len, x.data());
+			SizeT xLen = buf.len;
+			auto trim = [](const EleBuffer &z, SizeT len){
+				for(;(len > 1) && (Ele(0) == z[len - 1]);--len){}
+				return len;
+			};
+			
+			int top = std::numeric_limits<Unsigned>::digits - 1;
+			for(;Unsigned(0) == ((_exp >> top) & Unsigned(1));--top){}
+			for(int i = top - 1;i >= 0;--i){
+				squareDigitsFull(y.data(), x.data(), xLen);
+				xLen = trim(y, 2 * xLen);
+				std::swap(x, y);
+				if(Unsigned(0) != ((_exp >> i) & Unsigned(1))){
+					multiplyDigitsFull(y.data(), x.data(), xLen, buf.data, buf.len);
+					xLen = trim(y, xLen + buf.len);
+					std::swap(x, y);
+				}
+			}
+			
+			DigitBuffer _buf(&allocator, xLen);
+			constructZeroDigits(_buf);
+			std::copy(x.data(), x.data() + xLen, _buf.data);
+			takeDigits(_buf);
+			if(shift > 0){
+				shl(shift, std::false_type{});
+			}
+			positive = _positive;
+			return std::move(*this);
+		}
+		
+		// whether products modulo _m > 1 are done in Montgomery form
+		inline static bool useMontgomery(const BigInt &_m) noexcept{
+			return (Ele(0) != (_m.buf.data[0] & Ele(1))) && (_m.buf.len < _BIG_NUM_POWMOD_MONTGOMERY_THRESHOLD_);
+		}
+		
+		// _base ^ _exp in ring for 0 < _base < m and _exp > 0
+		template <class Ring>
+		inline static BigInt powModRing(Ring &ring, const BigInt &_base, const BigInt &_exp){
+			using Elem = typename Ring::Elem;
+			
+			LogSizeT k = powWindowSize(_exp.lenOfBinary());
+			SizeT cnt = SizeT(1) << (k - 1);
+			
+			// table[j] = _base ^ {2j + 1}
+			std::vector<Elem> table;
+			table.reserve(cnt);
+			table.push_back(ring.convert(_base));
+			if(cnt > 1){
+				Elem sq = table[0];
+				ring.square(sq);
+				for(SizeT j = 1;j < cnt;++j){
+					table.push_back(table[j - 1]);
+					ring.multiply(table[j], table[j], sq);
+				}
+			}
+			
+			Elem acc;
+			slideWindows(_exp, k, 
+				[&](SizeT w){
+					acc = table[w];
+				}, 
+				[&](){
+					ring.square(acc);
+				}, 
+				[&](SizeT w){
+					ring.multiply(acc, acc, table[w]);
+				});
+			return ring.recover(acc);
+		}
+		
+		// divideBy for operands of any sign, rounding the quotient towards zero
+		inline std::pair<BigInt, BigInt> divideSigned(BigInt &&_rhs) &&{
+			bool _positive1 = positive;
+			bool _positive2 = _rhs.positive;
+			positive = true;
+			_rhs.positive = true;
+			std::pair<BigInt, BigInt> res = std::move(*this).divideBy(_rhs);
+			res.first.positive = (_positive1 == _positive2) || res.first.isZero();
+			res.second.positive = _positive1 || res.second.isZero();
 			return res;
 		}
-		inline std::pair<BigInt, BigInt> divideBy(const BigInt &_rhs) const &{
-			//assert(positive);
-			//assert(_rhs.positive);
-			
-			return BigInt(*this).divideBy(_rhs);
+		inline std::pair<BigInt, BigInt> divideSigned(const BigInt &_rhs) &&{
+			if(!_rhs.positive){
+				return std::move(*this).divideSigned(BigInt(_rhs));
+			}
+			bool _positive = positive;
+			positive = true;
+			std::pair<BigInt, BigInt> res = std::move(*this).divideBy(_rhs);
+			res.first.positive = _positive || res.first.isZero();
+			res.second.positive = _positive || res.second.isZero();
+			return res;
 		}
 		
-		// for small integer types
+		// for unsigned types no wider than a digit. The quotient is the one of the
+		// absolute value
 		template <typename Unsigned>
 		inline std::pair<BigInt, Unsigned> divideByUnsigned(Unsigned _rhs, std::true_type) &&{
-			using sqrEle = typename _type::squareType<Ele>::type;
-			
-			Unsigned lastMod = 0;
+			Ele divisor = static_cast<Ele>(_rhs);
+			Ele lastMod(0);
 			for(SizeT i = buf.len;i > 0;--i){
-				sqrEle tmp = static_cast<sqrEle>(lastMod) << ENTRY_SIZE + buf.data[i - 1];
-				buf.data[i - 1] = tmp / _rhs;
-				lastMod = static_cast<Unsigned>(tmp % _rhs);
+				buf.data[i - 1] = _utility::divFull(lastMod, buf.data[i - 1], divisor, lastMod);
 			}
 			
 			buf.shrinkToFit();
 			positive = true;
 			
-			return std::make_pair(std::move(*this), lastMod);
-		}
-		template <typename Unsigned>
-		inline std::pair<BigInt, Unsigned> divideByUnsigned(Unsigned _rhs, std::true_type) const &{
-			using sqrEle = typename _type::squareType<Ele>::type;
-			
-			std::pair<BigInt, Unsigned> res(std::piecewise_construct_t{}, 
-				std::tuple<NullTag>(NullTag{}), std::tuple<Unsigned>(0));
-			
-			SizeT resLen = buf.len;
-			if(buf.data[buf.len - 1] < static_cast<Ele>(_rhs)){
-				resLen -= 1;
-				res.second = static_cast<Unsigned>(buf.data[buf.len - 1]);
-				if(buf.len == 1){
-					res.first.buf.data = res.first.allocator.allocate(1);
-					res.first.allocator.construct(res.first.buf.data + 0, 0);
-					return res;
-				}
-			}
-			
-			res.first.buf.setLen(resLen);
-			res.first.buf.data = res.first.allocator.allocate(static_cast<std::size_t>(res.first.buf.cap));
-			SizeT i = res.first.buf.len;
-			try{
-				for(;i > 0;--i){
-					sqrEle tmp = static_cast<sqrEle>(res.second) << ENTRY_SIZE + buf.data[i - 1];
-					res.second = static_cast<Unsigned>(tmp % _rhs);
-					res.first.allocator.construct(res.first.buf.data + i, tmp / _rhs);
-				}
-			}
-			catch(...){
-				destroyAll(res.first.buf.data + i, res.first.buf.data + res.first.buf.len, res.first.allocator);
-				res.first.allocator.deallocate(res.first.buf.data, static_cast<std::size_t>(res.first.buf.cap));
-				res.first.buf.data = nullptr;
-				res.first.buf.zeroLen();
-				
-				throw ;
-			}
-			
-			return res;
+			return std::pair<BigInt, Unsigned>(std::move(*this), static_cast<Unsigned>(lastMod));
 		}
 		// large Unsigned type
 		template <typename Unsigned>
 		inline std::pair<BigInt, Unsigned> divideByUnsigned(Unsigned _rhs, std::false_type) &&{
-			std::pair<BigInt, Unsigned> res(std::piecewise_construct_t{}, 
-				std::tuple<NullTag>(NullTag{}), std::tuple<Unsigned>(0));
+			using Common = typename std::common_type<Ele, Unsigned>::type;
 			
-			if((_rhs >> ENTRY_SIZE) == 0){
-				Ele _mod;
-				std::tie(res.first, _mod) = std::move(*this).divideByUnsigned(static_cast<Ele>(_rhs), std::true_type{});
-				res.second = static_cast<Unsigned>(_mod);
-				return res;
+			if(Common(0) == shrEntry(static_cast<Common>(_rhs))){
+				std::pair<BigInt, Ele> qr = std::move(*this).divideByUnsigned(static_cast<Ele>(_rhs), std::true_type{});
+				return std::pair<BigInt, Unsigned>(std::move(qr.first), static_cast<Unsigned>(qr.second));
 			}
 			
-			BigInt _mod(NullTag{});
-			std::tie(res.first, _mod) = std::move(*this).divideBy(BigInt(_rhs));
-			res.second = _mod.convertSingleDigit<Unsigned>();
-			return res;
+			positive = true;
+			std::pair<BigInt, BigInt> qr = std::move(*this).divideBy(BigInt(_rhs));
+			return std::pair<BigInt, Unsigned>(std::move(qr.first), qr.second.template convertSingleDigit<Unsigned>());
 		}
-		template <typename Unsigned>
-		inline std::pair<BigInt, Unsigned> divideByUnsigned(Unsigned _rhs, std::false_type) const &{
-			std::pair<BigInt, Unsigned> res(std::piecewise_construct_t{}, 
-				std::tuple<NullTag>(NullTag{}), std::tuple<Unsigned>(0));
-			
-			if((_rhs >> ENTRY_SIZE) == 0){
-				Ele _mod;
-				std::tie(res.first, _mod) = divideByUnsigned(static_cast<Ele>(_rhs), std::true_type{});
-				res.second = static_cast<Unsigned>(_mod);
-				return res;
-			}
-			
-			BigInt _mod(NullTag{});
-			std::tie(res.first, _mod) = divideBy(BigInt(_rhs));
-			res.second = _mod.convertSingleDigit<Unsigned>();
-			return res;
+		template <typename Unsigned, bool small>
+		inline std::pair<BigInt, Unsigned> divideByUnsigned(Unsigned _rhs, std::integral_constant<bool, small> tag) const &{
+			return BigInt(*this).divideByUnsigned(_rhs, tag);
 		}
 		
 		// unsigned int
-		/*template <typename Integer>
+		template <typename Integer>
 		inline std::pair<BigInt, Integer> divideByInt(Integer _rhs, std::false_type) &&{
-			return std::move(*this).divideByUnsigned(_rhs, std::integral_constant<bool, sizeof(Integer) <= ENTRY_SIZE>{});
+			bool _positive1 = positive;
+			
+			std::pair<BigInt, Integer> res = std::move(*this).divideByUnsigned(_rhs, 
+				std::integral_constant<bool, sizeof(Integer) * CHAR_BIT <= ENTRY_SIZE>{});
+			if(!_positive1){
+				res.first.changeSign();
+				res.second = Integer(0) - res.second;
+			}
+			return res;
 		}
-		template <typename Integer>
-		inline std::pair<BigInt, Integer> divideByInt(Integer _rhs, std::false_type) const &{
-			return divideByUnsigned(_rhs, std::integral_constant<bool, sizeof(Integer) <= ENTRY_SIZE>{});
-		}*/
 		// signed int
 		template <typename Integer>
 		inline std::pair<BigInt, Integer> divideByInt(Integer _rhs, std::true_type) &&{
 			using Unsigned = typename std::make_unsigned<Integer>::type;
-			std::pair<BigInt, Unsigned> res(std::piecewise_construct_t{}, 
-				std::tuple<NullTag>(NullTag{}), std::tuple<Unsigned>(0));
 			
 			bool _positive1 = positive;
 			
-			if(_rhs > 0){
-				Unsigned _mod;
-				std::tie(res.first, _mod) = std::move(*this).divideByUnsigned(static_cast<Unsigned>(_rhs), 
-					std::integral_constant<bool, sizeof(Unsigned) <= ENTRY_SIZE>{});
-				res.second = static_cast<Integer>(_mod);
-				if(!_positive1){
-					res.first.changeSign();
-					res.second = -res.second;
-				}
-				return res;
-			}
-			
-			if(Integer(1 << (sizeof(Integer) * CHAR_BIT - 1)) == _rhs){
-				Unsigned _mod = convertSingleDigit<Unsigned>(sizeof(Integer) * CHAR_BIT - 1);
-				res.second = static_cast<Integer>(_mod);
-				shr(sizeof(Integer) * CHAR_BIT - 1, std::false_type{});
-				res.first = std::move(*this);
-			}
-			else{
-				Unsigned _mod;
-				std::tie(res.first, _mod) = std::move(*this).divideByUnsigned(static_cast<Unsigned>(-_rhs), 
-					std::integral_constant<bool, sizeof(Unsigned) <= ENTRY_SIZE>{});
-				res.second = static_cast<Integer>(_mod);
-			}
-			
+			// negating in the unsigned type also works for the minimum value
+			Unsigned divisor = (_rhs < 0)? static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(_rhs)): static_cast<Unsigned>(_rhs);
+			std::pair<BigInt, Unsigned> qr = std::move(*this).divideByUnsigned(divisor, 
+				std::integral_constant<bool, sizeof(Unsigned) * CHAR_BIT <= ENTRY_SIZE>{});
+			std::pair<BigInt, Integer> res(std::move(qr.first), static_cast<Integer>(qr.second));
 			
-			if(_positive1){
+			if(_positive1 != (_rhs > 0)){
 				res.first.changeSign();
 			}
-			else{
+			if(!_positive1){
 				res.second = -res.second;
 			}
 			return res;
 		}
+		template <typename Integer, bool isSignedInt>
+		inline std::pair<BigInt, Integer> divideByInt(Integer _rhs, std::integral_constant<bool, isSignedInt> tag) const &{
+			return BigInt(*this).divideByInt(_rhs, tag);
+		}
+		
+		// unsigned int
 		template <typename Integer>
-		inline std::pair<BigInt, Integer> divideByInt(Integer _rhs, std::true_type) const &{
-			using Unsigned = typename std::make_unsigned<Integer>::type;
-			std::pair<BigInt, Unsigned> res(std::piecewise_construct_t{}, 
-				std::tuple<NullTag>(NullTag{}), std::tuple<Unsigned>(0));
-			
-			bool _positive1 = positive;
-			
-			if(_rhs > 0){
-				Unsigned _mod;
-				std::tie(res.first, _mod) = divideByUnsigned(static_cast<Unsigned>(_rhs), 
-					std::integral_constant<bool, sizeof(Unsigned) <= ENTRY_SIZE>{});
-				res.second = static_cast<Integer>(_mod);
-				if(!_positive1){
-					res.first.changeSign();
-					res.second = -res.second;
-				}
-				return res;
-			}
-			
-			if(Integer(1 << (sizeof(Integer) * CHAR_BIT - 1)) == _rhs){
-				Unsigned _mod = convertSingleDigit<Unsigned>(sizeof(Integer) * CHAR_BIT - 1);
-				res.second = static_cast<Integer>(_mod);
-				res.first = *this;
-				res.first.shr(sizeof(Integer) * CHAR_BIT - 1, std::false_type{});
-			}
-			else{
-				Unsigned _mod;
-				std::tie(res.first, _mod) = divideByUnsigned(static_cast<Unsigned>(-_rhs), 
-					std::integral_constant<bool, sizeof(Unsigned) <= ENTRY_SIZE>{});
-				res.second = static_cast<Integer>(_mod);
+		inline std::pair<Integer, Integer> divideOfInt(Integer _lhs, std::false_type) const{
+			std::int8_t comp = buf.compareUnsignedIntBuffer(_lhs, 
+				std::integral_constant<SizeT, (sizeof(Integer) * CHAR_BIT + ENTRY_SIZE - 1) / ENTRY_SIZE>{});
+			if(comp == 1){
+				return std::pair<Integer, Integer>(Integer(0), _lhs);
 			}
 			
-			if(_positive1){
-				res.first.changeSign();
-			}
-			else{
-				res.second = -res.second;
+			Integer _divisior = convertSingleDigit<Integer>();
+			Integer q = _lhs / _divisior;
+			if(!positive){
+				q = Integer(0) - q;
 			}
-			return res;
+			return std::pair<Integer, Integer>(q, _lhs % _divisior);
 		}
-		
 		// signed int
 		template <typename Integer>
 		inline std::pair<Integer, Integer> divideOfInt(Integer _lhs, std::true_type) const{
 			using Unsigned = typename std::make_unsigned<Integer>::type;
 			
-			bool _positive2 = positive;
-			
-			Unsigned _dividend;
-			if(_lhs > 0){
-				_dividend = static_cast<Unsigned>(_lhs);
-			}
-			else{
-				_dividend = static_cast<Unsigned>(~_lhs) + 1;
-			}
+			Unsigned _dividend = (_lhs < 0)? static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(_lhs)): static_cast<Unsigned>(_lhs);
 			std::int8_t comp = buf.compareUnsignedIntBuffer(_dividend, 
 				std::integral_constant<SizeT, (sizeof(Unsigned) * CHAR_BIT + ENTRY_SIZE - 1) / ENTRY_SIZE>{});
 			if(comp == 1){
-				return std::make_pair(0, _lhs);
+				return std::pair<Integer, Integer>(Integer(0), _lhs);
 			}
 			
-			Unsigned tmp = convertSingleDigit<Unsigned>();
-			Integer _divisior = static_cast<Integer>(tmp);
-			assert(_divisior > 0);
-			if(!_positive2){
-				_divisior = -_divisior;
+			Unsigned _divisior = convertSingleDigit<Unsigned>();
+			Unsigned q = _dividend / _divisior;
+			Unsigned r = _dividend % _divisior;
+			if(positive != (_lhs >= 0)){
+				q = Unsigned(0) - q;
 			}
-			return std::make_pair(_lhs / _divisior, _lhs % _divisior);
+			if(_lhs < 0){
+				r = Unsigned(0) - r;
+			}
+			return std::pair<Integer, Integer>(static_cast<Integer>(q), static_cast<Integer>(r));
 		}
 		
-		inline BigInt modularByMedium(const BigInt &_rhs) &&{
+		inline BigInt modularByMedium(const BigInt &_rhs, const DivisorHint *hint = nullptr) &&{
 			//assert(positive);
 			//assert(_rhs.positive);
 			if(_rhs.isZero()){
@@ -4066,11 +5227,18 @@ namespace bignum{
 			}
 			assert(buf.len >= _rhs.buf.len);
 			assert(buf.len <= _rhs.buf.len * 2);
+			if(useRecursiveDivision(_rhs)){
+				return std::move(std::move(*this).divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm).second);
+			}
+			if(nullptr != hint){
+				assert(nullptr != hint->miu);
+				return std::move(*this).barretResident(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
+			}
 			//SizeT lenBin = lenOfBinary();
 			//return std::move(*this).barretResident(_rhs, _rhs.newtonInverse(lenBin));
-			return std::move(*this).barretResident(_rhs, _rhs.newtonInverse(buf.len * ENTRY_SIZE));
+			return std::move(*this).barretResident(_rhs, _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE));
 		}
-		inline BigInt modularByMedium(const BigInt &_rhs) const &{
+		inline BigInt modularByMedium(const BigInt &_rhs, const DivisorHint *hint = nullptr) const &{
 			//assert(positive);
 			//assert(_rhs.positive);
 			if(_rhs.isZero()){
@@ -4082,12 +5250,19 @@ namespace bignum{
 			}
 			assert(buf.len >= _rhs.buf.len);
 			assert(buf.len <= _rhs.buf.len * 2);
+			if(useRecursiveDivision(_rhs)){
+				return std::move(divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm).second);
+			}
+			if(nullptr != hint){
+				assert(nullptr != hint->miu);
+				return barretResident(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
+			}
 			//SizeT lenBin = lenOfBinary();
 			//return barretResident(_rhs, _rhs.newtonInverse(lenBin));
-			return barretResident(_rhs, _rhs.newtonInverse(buf.len * ENTRY_SIZE));
+			return barretResident(_rhs, _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE));
 		}
 		
-		inline BigInt modularBy(const BigInt &_rhs) &&{
+		inline BigInt modularBy(const BigInt &_rhs, const DivisorHint *hint = nullptr) &&{
 			//assert(positive);
 			//assert(_rhs.positive);
 			if(_rhs.isZero()){
@@ -4101,146 +5276,108 @@ namespace bignum{
 			if(buf.len < _rhs.buf.len){
 				return std::move(*this);
 			}
+			if(1 == _rhs.buf.len){
+				return BigInt(modularByUnsigned(_rhs.buf.data[0], std::true_type{}));
+			}
+			if(useRecursiveDivision(_rhs)){
+				return std::move(std::move(*this).divideByRecursive(_rhs, (nullptr == hint)? nullptr: hint->norm).second);
+			}
 			
 			if(buf.len <= _rhs.buf.len * 2){
 				try{
-					return std::move(*this).modularByMedium(_rhs);
+					return std::move(*this).modularByMedium(_rhs, hint);
 				}
 				catch(std::domain_error &){
 					assert(false);
 				}
 			}
 			
-			// TODO: avoid unnecessary memory allocation
-			BigInt miu = _rhs.newtonInverse(2 * _rhs.buf.len * ENTRY_SIZE);
-			SizeT L = buf.len;
-			while(L >= 2 * _rhs.buf.len){
-				BigInt R = subStr(L - 2 * _rhs.buf.len, L).barretResident(_rhs, miu);
-				
-				if(R.isZero()){
-					destroyAll(buf.data + (L - 2 * _rhs.buf.len), buf.data + L, allocator);
-					L -= 2 * _rhs.buf.len;
-				}
-				else{
-					for(SizeT i(0);i < R.buf.len;++i){
-						buf.data[L - 2 * _rhs.buf.len + i] = std::move(R.buf.data[i]);
-					}
-					destroyAll(buf.data + (L - 2 * _rhs.buf.len + R.buf.len), buf.data + L, allocator);
-					L -= 2 * _rhs.buf.len - R.buf.len;
-				}
+			// the same digit blocks as divideBy, but only the remainder is kept
+			SizeT n = _rhs.buf.len;
+			BigInt miu;
+			TransformCache rhsCache, miuCache;
+			DivisorHint local{nullptr, &miu, &rhsCache, &miuCache};
+			if(nullptr == hint){
+				// TODO: avoid unnecessary memory allocation
+				miu = _rhs.newtonInverse(2 * n * ENTRY_SIZE);
+				hint = &local;
 			}
 			
-			_BIG_NUM_ADD_FINALIZER_CODE_(
-				destroyAll(buf.data, buf.data + L, allocator);
-				allocator.deallocate(buf.data, static_cast<std::size_t>(buf.cap));
-				buf.data = nullptr;
-				buf.zeroLen();
-			);
-			
-			assert(L < 2 * _rhs.buf.len);
-			if(L >= _rhs.buf.len){
-				BigInt tmp = subStr(0, L);
-				SizeT tmpLenBin = tmp.lenOfBinary();
-				BigInt resident = std::move(tmp).barretResident(_rhs, _rhs.newtonInverse(tmpLenBin));
-				
-				return resident;
-			}
-			else{
-				BigInt resident;
+			BigInt resident;
+			for(SizeT st = (buf.len - 1) / n * n;true;st -= n){
+				BigInt cur = subStr(st, st + n);
+				cur.buf.shrinkToFit();
+				if(!resident.isZero()){
+					resident.shl(n * ENTRY_SIZE, std::false_type{});
+					cur.add(std::move(resident));
+				}
 				
-				destroyAll(resident.buf.data, resident.buf.data + resident.buf.len, resident.allocator);
-				resident.allocator.deallocate(resident.buf.data, static_cast<std::size_t>(resident.buf.cap));
-				resident.buf.setLen(L);
-				resident.buf.data = resident.allocator.allocate(static_cast<std::size_t>(resident.buf.cap));
-				SizeT i(0);
-				try{
-					for(;i < L;++i){
-						resident.allocator.construct(resident.buf.data + i, std::move(buf.data[i]));
-					}
+				if(cur < _rhs){
+					resident = std::move(cur);
 				}
-				catch(...){
-					destroyAll(resident.buf.data, resident.buf.data + i, resident.allocator);
-					resident.allocator.deallocate(resident.buf.data, static_cast<std::size_t>(resident.buf.cap));
-					resident.buf.data = nullptr;
-					resident.zeroLen();
-					
-					throw ;
+				else{
+					resident = std::move(cur).barretResident(_rhs, *hint->miu, hint->rhsCache, hint->miuCache);
 				}
 				
-				return resident;
+				if(0 == st){
+					break;
+				}
 			}
+			
+			return resident;
 		}
-		inline BigInt modularBy(const BigInt &_rhs) const &{
+		inline BigInt modularBy(const BigInt &_rhs, const DivisorHint *hint = nullptr) const &{
 			//assert(positive);
 			//assert(_rhs.positive);
 			
-			return BigInt(*this).modularBy(_rhs);
+			return BigInt(*this).modularBy(_rhs, hint);
 		}
 		
 		// small unsigned types
 		template <typename Unsigned>
 		inline Unsigned modularByUnsigned(Unsigned _rhs, std::true_type) const{
-			using sqrEle = typename _type::squareType<Ele>::type;
-			
-			Unsigned lastMod = 0;
+			Ele divisor = static_cast<Ele>(_rhs);
+			Ele lastMod(0);
 			for(SizeT i = buf.len;i > 0;--i){
-				sqrEle tmp = static_cast<sqrEle>(lastMod) << ENTRY_SIZE + buf.data[i - 1];
-				lastMod = static_cast<Unsigned>(tmp % _rhs);
+				_utility::divFull(lastMod, buf.data[i - 1], divisor, lastMod);
 			}
 			
-			return lastMod;
+			return static_cast<Unsigned>(lastMod);
 		}
 		// large unsigned types
 		template <typename Unsigned>
-		inline Unsigned modularByUnsigned(Unsigned _rhs, std::false_type) &&{
-			if((_rhs >> ENTRY_SIZE) == 0){
-				Ele _mod = std::move(*this).modularByUnsigned(static_cast<Ele>(_rhs), std::true_type{});
-				return static_cast<Unsigned>(_mod);
-			}
+		inline Unsigned modularByUnsigned(Unsigned _rhs, std::false_type) const{
+			using Common = typename std::common_type<Ele, Unsigned>::type;
 			
-			BigInt _mod = std::move(*this).modularBy(BigInt(_rhs));
-			return _mod.convertSingleDigit<Unsigned>();
-		}
-		template <typename Unsigned>
-		inline Unsigned modularByUnsigned(Unsigned _rhs, std::false_type) const &{
-			if((_rhs >> ENTRY_SIZE) == 0){
-				Ele _mod = modularByUnsigned(static_cast<Ele>(_rhs), std::true_type{});
-				return static_cast<Unsigned>(_mod);
+			if(Common(0) == shrEntry(static_cast<Common>(_rhs))){
+				return static_cast<Unsigned>(modularByUnsigned(static_cast<Ele>(_rhs), std::true_type{}));
 			}
 			
-			BigInt _mod = modularBy(BigInt(_rhs));
-			return _mod.convertSingleDigit<Unsigned>();
+			BigInt tmp = *this;
+			tmp.positive = true;
+			return std::move(tmp).modularBy(BigInt(_rhs)).template convertSingleDigit<Unsigned>();
 		}
 		
+		// unsigned int
+		template <typename Integer>
+		inline Integer modularByInt(Integer _rhs, std::false_type) const{
+			Integer res = modularByUnsigned(_rhs, 
+				std::integral_constant<bool, sizeof(Integer) * CHAR_BIT <= ENTRY_SIZE>{});
+			if(!positive){
+				res = Integer(0) - res;
+			}
+			return res;
+		}
 		// signed int
 		template <typename Integer>
-		inline Integer divideByInt(Integer _rhs, std::true_type) &&{
+		inline Integer modularByInt(Integer _rhs, std::true_type) const{
 			using Unsigned = typename std::make_unsigned<Integer>::type;
 			
-			bool _positive1 = positive;
-			
-			if(Integer(1 << (sizeof(Integer) * CHAR_BIT - 1)) == _rhs){
-				Unsigned _mod = convertSingleDigit<Unsigned>(sizeof(Integer) * CHAR_BIT - 1);
-				Integer res = static_cast<Integer>(_mod);
-				assert(res >= 0);
-				if(!_positive1){
-					res = -res;
-				}
-				return res;
-			}
-			
-			Unsigned tmp;
-			if(_rhs > 0){
-				tmp = static_cast<Unsigned>(_rhs);
-			}
-			else{
-				tmp = static_cast<Unsigned>(~_rhs) + 1;
-			}
-			Unsigned _mod = std::move(*this).modularByUnsigned(tmp, 
-				std::integral_constant<bool, sizeof(Unsigned) <= ENTRY_SIZE>{});
-			Integer res = static_cast<Integer>(_mod);
+			Unsigned divisor = (_rhs < 0)? static_cast<Unsigned>(Unsigned(0) - static_cast<Unsigned>(_rhs)): static_cast<Unsigned>(_rhs);
+			Integer res = static_cast<Integer>(modularByUnsigned(divisor, 
+				std::integral_constant<bool, sizeof(Unsigned) * CHAR_BIT <= ENTRY_SIZE>{}));
 			assert(res >= 0);
-			if(!_positive1){
+			if(!positive){
 				res = -res;
 			}
 			return res;
@@ -4266,9 +5403,9 @@ namespace bignum{
 	// have to be defined outside class scope. For constexpr static members declared in
 	// a template class, defination can be like those below:
 	//template <class Allocator>
-	//constexpr typename BigInt<Allocator>::Ele BigInt<Allocator>::OMEGA;
+	//constexpr typename BigInt<Allocator>::Coef BigInt<Allocator>::OMEGA1;
 	//template <class Allocator>
-	//constexpr typename BigInt<Allocator>::Ele BigInt<Allocator>::TWO_INV;
+	//constexpr typename BigInt<Allocator>::Coef BigInt<Allocator>::P1;
 	
 	template <class Alloc>
 	inline void swap(BigInt<Alloc> &_lhs, BigInt<Alloc> &_rhs){
@@ -0,0 +1,151 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_INT_DIVISOR_HPP_
+#define _BIG_INT_DIVISOR_HPP_
+
+#include <type_traits>
+#include <utility>
+#include <stdexcept>
+
+#include "../Libs/BigNumTypeTrait.hpp"
+#include "../Libs/BigNumWord.hpp"
+
+namespace bignum{
+	
+	// a fixed divisor (e.g. a modulus) that divides many other numbers. Whatever
+	// division by it needs beyond the digits of the divisor is computed once: the
+	// divisor shifted to set its top bit for recursive division, or its reciprocal
+	// for Barrett reduction when it is long, together with the transforms of both.
+	// Results are the same as of operator/ and operator%.
+	// 
+	// div(), mod() and divmod() update the kept transforms, so an object must not be
+	// shared between threads without synchronization.
+	template <class BI>
+	class Divisor{
+	private:
+		using Ele = typename BI::Ele;
+		using EleBuffer = typename BI::EleBuffer;
+		using TransformCache = typename BI::TransformCache;
+		using DivisorHint = typename BI::DivisorHint;
+		using SizeT = typename BI::SizeT;
+	public:
+		// transforms are keyed by the addresses of the digits, so a copy starts with
+		// none of them
+		Divisor(const Divisor &_rhs)
+			:num(_rhs.num), positive(_rhs.positive), norm(_rhs.norm), miu(_rhs.miu),
+			numCache(), miuCache(){}
+		Divisor(Divisor &&) = default;
+		
+		Divisor &operator=(const Divisor &_rhs){
+			if(this != &_rhs){
+				num = _rhs.num;
+				positive = _rhs.positive;
+				norm = _rhs.norm;
+				miu = _rhs.miu;
+				numCache.entries.clear();
+				miuCache.entries.clear();
+			}
+			return *this;
+		}
+		Divisor &operator=(Divisor &&_rhs){
+			if(this != &_rhs){
+				// the digits may be copied instead of taken over
+				num = std::move(_rhs.num);
+				positive = _rhs.positive;
+				norm = std::move(_rhs.norm);
+				miu = std::move(_rhs.miu);
+				numCache.entries.clear();
+				miuCache.entries.clear();
+			}
+			return *this;
+		}
+		
+		~Divisor() = default;
+		
+		template <class BIRef,
+			typename std::enable_if<isRLRef<BI, BIRef &&>::value>::type * = nullptr>
+		explicit Divisor(BIRef &&_num)
+			:num(std::forward<BIRef>(_num)), positive(true), norm(), miu(), numCache(), miuCache(){
+			if(num.isZero()){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			
+			// divisions are done on absolute values
+			positive = num.positive;
+			num.positive = true;
+			
+			SizeT n = num.buf.len;
+			if(n < 2){
+				// single digits are divided directly
+				return ;
+			}
+			if(BI::useRecursiveDivision(num)){
+				int shift = _utility::countLeadingZero(num.buf.data[n - 1]);
+				norm.assign(num.buf.data, num.buf.data + n);
+				if(0 != shift){
+					_utility::shlDigits(norm.data(), norm.data(), n, shift);
+				}
+			}
+			else{
+				miu = num.newtonInverse(2 * n * BI::ENTRY_SIZE);
+			}
+		}
+		
+		BI value() const{
+			BI res(num);
+			res.positive = positive;
+			return res;
+		}
+		
+		std::pair<BI, BI> divmod(const BI &_lhs){
+			return divmod(BI(_lhs));
+		}
+		std::pair<BI, BI> divmod(BI &&_lhs){
+			bool _positive = _lhs.positive;
+			_lhs.positive = true;
+			DivisorHint hint = makeHint();
+			std::pair<BI, BI> res = std::move(_lhs).divideBy(num, &hint);
+			res.first.positive = (_positive == positive) || res.first.isZero();
+			res.second.positive = _positive || res.second.isZero();
+			return res;
+		}
+		
+		BI div(const BI &_lhs){
+			return std::move(divmod(BI(_lhs)).first);
+		}
+		BI div(BI &&_lhs){
+			return std::move(divmod(std::move(_lhs)).first);
+		}
+		
+		BI mod(const BI &_lhs){
+			return mod(BI(_lhs));
+		}
+		BI mod(BI &&_lhs){
+			bool _positive = _lhs.positive;
+			_lhs.positive = true;
+			DivisorHint hint = makeHint();
+			BI res = std::move(_lhs).modularBy(num, &hint);
+			res.positive = _positive || res.isZero();
+			return res;
+		}
+	private:
+		DivisorHint makeHint(){
+			return DivisorHint{norm.empty()? nullptr: norm.data(),
+				miu.isZero()? nullptr: &miu, &numCache, &miuCache};
+		}
+		
+		// the absolute value of the divisor, and its sign
+		BI num;
+		bool positive;
+		// num shifted to set its top bit, kept if recursive division is used
+		EleBuffer norm;
+		// num.newtonInverse(2 * n * ENTRY_SIZE), kept if Barrett reduction is used
+		BI miu;
+		TransformCache numCache, miuCache;
+	};// class Divisor
+	
+};// namespace bignum
+#endif // _BIG_INT_DIVISOR_HPP_
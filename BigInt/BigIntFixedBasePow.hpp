@@ -0,0 +1,211 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_INT_FIXED_BASE_POW_HPP_
+#define _BIG_INT_FIXED_BASE_POW_HPP_
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+#include "BigIntModular.hpp"
+
+namespace bignum{
+	
+	namespace _type{
+		
+		// Lim-Lee comb for powers of a fixed g in ring. An exponent of at most
+		// h * v * b bits is written as h rows of a = v * b bits, each cut into v
+		// blocks of b bits, so that bit c of block j of row i has the weight
+		// 2^{i * a + j * b + c}. For every block j the table keeps
+		// G[j][u] = prod_{bit i of u} g ^ {2^{i * a + j * b}}, u in [1, 2^h), and a
+		// power takes b - 1 squarings and at most v * b multiplications by G[j][u],
+		// u being the bits at the same column of all rows.
+		template <class BI, class Ring>
+		class CombTable{
+		private:
+			using Elem = typename Ring::Elem;
+			using Ele = typename BI::Ele;
+			using SizeT = typename BI::SizeT;
+		public:
+			CombTable(Ring &&_ring, const BI &g, SizeT expBits, unsigned _h, unsigned _v)
+				:ring(std::move(_ring)), h(_h), v(_v),
+				b(static_cast<SizeT>((expBits + _h * _v - 1) / (_h * _v))), table(){
+				if(0 == b){
+					b = 1;
+				}
+				SizeT rowSize = (SizeT(1) << h) - 1;
+				table.reserve(v * rowSize);
+				
+				// g ^ {2^{s * b}} for the s-th block of all, stored at its single bit
+				Elem cur = ring.convert(g);
+				std::vector<Elem> single;
+				single.reserve(h * v);
+				for(SizeT s = 0;s < h * v;++s){
+					if(s > 0){
+						for(SizeT c = 0;c < b;++c){
+							ring.square(cur);
+						}
+					}
+					single.push_back(cur);
+				}
+				
+				for(SizeT j = 0;j < v;++j){
+					for(SizeT u = 1;u <= rowSize;++u){
+						// the lowest bit of u times the entry of the others
+						SizeT i = 0;
+						for(;0 == ((u >> i) & 1);++i){}
+						table.push_back(single[i * v + j]);
+						SizeT rest = u & (u - 1);
+						if(0 != rest){
+							Elem &last = table.back();
+							ring.multiply(last, last, table[j * rowSize + (rest - 1)]);
+						}
+					}
+				}
+			}
+			
+			// the longest exponent the table covers
+			SizeT capacity() const noexcept{
+				return static_cast<SizeT>(h * v) * b;
+			}
+			
+			// g ^ _exp for 0 <= _exp < 2^{capacity()}
+			BI pow(const BI &_exp){
+				auto bit = [&_exp](SizeT i){
+					SizeT idx = i / BI::ENTRY_SIZE;
+					return (idx < _exp.buf.len) &&
+						(Ele(0) != ((_exp.buf.data[idx] >> (i % BI::ENTRY_SIZE)) & Ele(1)));
+				};
+				
+				SizeT rowSize = (SizeT(1) << h) - 1;
+				SizeT a = v * b;
+				Elem acc;
+				bool started = false;
+				for(SizeT c = b;c > 0;--c){
+					if(started){
+						ring.square(acc);
+					}
+					for(SizeT j = v;j > 0;--j){
+						SizeT u(0);
+						for(SizeT i = h;i > 0;--i){
+							u = (u << 1) | SizeT(bit((i - 1) * a + (j - 1) * b + (c - 1)));
+						}
+						if(0 == u){
+							continue;
+						}
+						
+						const Elem &entry = table[(j - 1) * rowSize + (u - 1)];
+						if(started){
+							ring.multiply(acc, acc, entry);
+						}
+						else{
+							acc = entry;
+							started = true;
+						}
+					}
+				}
+				
+				if(!started){
+					acc = ring.one();
+				}
+				return ring.recover(acc);
+			}
+		private:
+			Ring ring;
+			SizeT h, v, b;
+			std::vector<Elem> table;
+		};// class CombTable
+	
+	};// namespace _type
+	
+	// powers of a fixed base modulo a fixed modulus, e.g. of a generator, for many
+	// exponents. A Lim-Lee comb table is precomputed for exponents of up to
+	// expBits bits. It holds blocks * (2^{rows} - 1) residues, and a power then
+	// takes about expBits / (rows * blocks) squarings and expBits / rows
+	// multiplications. Longer exponents are left to powmod.
+	// 
+	// Like powmod, results are in [0, |mod|), and a negative base is taken as its
+	// non-negative residue.
+	// 
+	// pow() updates the buffers kept for products, so an object must not be shared
+	// between threads without synchronization.
+	template <class BI>
+	class FixedBasePow{
+	private:
+		using SizeT = typename BI::SizeT;
+		using MontgomeryTable = _type::CombTable<BI, _type::MontgomeryRing<BI>>;
+		using DivisorTable = _type::CombTable<BI, _type::DivisorRing<BI>>;
+	public:
+		FixedBasePow(const FixedBasePow &_rhs)
+			:base(_rhs.base), mod(_rhs.mod),
+			mont(_rhs.mont? new MontgomeryTable(*_rhs.mont): nullptr),
+			other(_rhs.other? new DivisorTable(*_rhs.other): nullptr){}
+		FixedBasePow(FixedBasePow &&) = default;
+		
+		FixedBasePow &operator=(const FixedBasePow &_rhs){
+			if(this != &_rhs){
+				FixedBasePow tmp(_rhs);
+				*this = std::move(tmp);
+			}
+			return *this;
+		}
+		FixedBasePow &operator=(FixedBasePow &&) = default;
+		
+		~FixedBasePow() = default;
+		
+		FixedBasePow(const BI &_base, const BI &_mod, SizeT expBits, unsigned rows = 6, unsigned blocks = 2)
+			:base(), mod(_mod), mont(), other(){
+			if(mod.isZero()){
+				throw std::domain_error("divide by zero");
+				// errno = ERANGE;
+			}
+			if((0 == rows) || (rows > 16) || (0 == blocks) || (blocks > 1024)){
+				throw std::domain_error("FixedBasePow: rows must be in [1, 16] and blocks in [1, 1024]");
+				// errno = EDOM;
+			}
+			
+			mod.positive = true;
+			base = _base % mod;
+			if(!base.positive){
+				base += mod;
+			}
+			
+			if(BI::useMontgomery(mod)){
+				mont.reset(new MontgomeryTable(_type::MontgomeryRing<BI>(mod), base, expBits, rows, blocks));
+			}
+			else{
+				other.reset(new DivisorTable(_type::DivisorRing<BI>(mod), base, expBits, rows, blocks));
+			}
+		}
+		
+		// base ^ _exp mod |mod| for a non-negative _exp
+		BI pow(const BI &_exp){
+			if(!_exp.positive){
+				throw std::domain_error("negative exponent");
+				// errno = EDOM;
+			}
+			
+			SizeT bits = _exp.lenOfBinary();
+			if(mont){
+				if(bits <= mont->capacity()){
+					return mont->pow(_exp);
+				}
+			}
+			else if(bits <= other->capacity()){
+				return other->pow(_exp);
+			}
+			return powmod(base, _exp, mod);
+		}
+	private:
+		// the residue of the base and the absolute value of the modulus
+		BI base, mod;
+		// one of them holds the table
+		std::unique_ptr<MontgomeryTable> mont;
+		std::unique_ptr<DivisorTable> other;
+	};// class FixedBasePow
+	
+};// namespace bignum
+#endif // _BIG_INT_FIXED_BASE_POW_HPP_
@@ -537,21 +537,23 @@ namespace bignum{
 	private:
 		using SizeT = typename BI::SizeT;
 		using LogSizeT = typename BI::LogSizeT;
+		using Ele = typename BI::Ele;
 		
 		static constexpr LogSizeT ENTRY_SIZE = BI::ENTRY_SIZE;
 	public:
 		explicit _SmallPower2RadixAutomatic(Diff _dist, SizeT _exp)
-			:num(typename BI::NullTag{}), dist(_dist), exp(_exp){
+			:dist(_dist), exp(_exp), count(0), num(typename BI::NullTag{}){
 			assert(dist > 0);
 			assert(exp < ENTRY_SIZE);
 			
 			SizeT _len = (exp * _dist + ENTRY_SIZE - 1) / ENTRY_SIZE;
+			num.positive = true;
 			num.buf.setLen(_len);
-			num.allocator.allocate(num.buf.data, static_cast<std::size_t>(num.buf.cap));
+			num.buf.data = num.allocator.allocate(static_cast<std::size_t>(num.buf.cap));
 			SizeT i = 0;
 			try{
 				for(;i < num.buf.len;++i){
-					num.allocator.construct(num.buf.data + i, 0);
+					num.allocator.construct(num.buf.data + i, Ele(0));
 				}
 			}
 			catch(...){
@@ -572,38 +574,44 @@ namespace bignum{
 		~_SmallPower2RadixAutomatic() = default;
 		
 		void _setDigit(Digit digit, Diff count){
-			assert(digit < (1 << exp));
+			assert(static_cast<Ele>(digit) < (Ele(1) << exp));
 			
 			assert(count < dist);
 			SizeT curI = ((dist - 1 - count) * exp) / ENTRY_SIZE;
 			LogSizeT curBit = ((dist - 1 - count) * exp) % ENTRY_SIZE;
 			
+			// Digit may be narrower than Ele, e.g. char for literals
+			Ele _digit = static_cast<Ele>(digit);
 			if(curBit + exp <= ENTRY_SIZE){
-				num.buf.data[curI] |= digit << curBit;
+				num.buf.data[curI] |= static_cast<Ele>(_digit << curBit);
 			}
 			else{
 				assert(curI + 1 < num.buf.len);
-				num.buf.data[curI] |= (digit & ((1 << (ENTRY_SIZE - curBit)) - 1)) << curBit;
-				num.buf.data[curI + 1] |= digit >> (ENTRY_SIZE - curBit);
+				num.buf.data[curI] |= static_cast<Ele>((_digit & ((Ele(1) << (ENTRY_SIZE - curBit)) - 1)) << curBit);
+				num.buf.data[curI + 1] |= _digit >> (ENTRY_SIZE - curBit);
 			}
 		}
 		
 		void _readDigit(Digit digit){
-			assert(digit < (1 << exp));
+			assert(static_cast<Ele>(digit) < (Ele(1) << exp));
 			_setDigit(digit, count);
 			++count;
 		}
 		
 		BI _finish() &&{
+			// leading zero digits
+			num.buf.shrinkToFit();
 			return std::move(num);
 		}
 		BI _finish() &{
-			return num;
+			BI res = num;
+			res.buf.shrinkToFit();
+			return res;
 		}
 	private:
 		Diff dist;
 		SizeT exp;
-				
+		
 		Diff count;
 		BI num;
 	};
@@ -634,10 +642,11 @@ namespace bignum{
 		~_SmallPower2RadixAutomatic() = default;
 		
 		void _readDigit(Digit digit){
-			assert(digit < (1 << exp));
+			assert(static_cast<Ele>(digit) < (Ele(1) << exp));
 			
+			Ele _digit = static_cast<Ele>(digit);
 			if(curBit >= exp){
-				num.buf.data[curI] |= digit << (curBit - exp);
+				num.buf.data[curI] |= static_cast<Ele>(_digit << (curBit - exp));
 				curBit -= exp;
 				return ;
 			}
@@ -652,7 +661,7 @@ namespace bignum{
 						num.allocator.construct(tmp.data + i - 1, num.buf.data[i - num.buf.len - 1]);
 					}
 					for(i = num.buf.len;i > 0;--i){
-						num.allocator.construct(tmp.data + i - 1, 0);
+						num.allocator.construct(tmp.data + i - 1, Ele(0));
 					}
 				}
 				catch(...){
@@ -675,8 +684,8 @@ namespace bignum{
 			}
 			
 			assert(curI > 0);
-			num.buf.data[curI] |= digit >> (exp - curBit);
-			num.buf.data[curI - 1] |= (digit & ((1 << (exp - curBit)) - 1)) << (ENTRY_SIZE + curBit - exp);
+			num.buf.data[curI] |= _digit >> (exp - curBit);
+			num.buf.data[curI - 1] |= static_cast<Ele>((_digit & ((Ele(1) << (exp - curBit)) - 1)) << (ENTRY_SIZE + curBit - exp));
 			curBit = ENTRY_SIZE + curBit - exp;
 			--curI;
 			
@@ -685,52 +694,14 @@ namespace bignum{
 		
 		BI _finish() &&{
 			assert(num.buf.len == num.buf.cap);
-			//assert((curI + curBit / ENTRY_SIZE) * 2 < num.buf.len);
-			if((curI == 0) && (curBit == 0)){
-				return std::move(num);
-			}
-			for(SizeT i = 0;i + curI < num.buf.len - 1;++i){
-				num.buf.data[i] = (num.buf.data[i + curI] >> curBit) | ((num.buf.data[i + curI + 1] & ((1 << curBit) - 1)) << (ENTRY_SIZE - curBit));
-			}
-			num.buf.data[num.buf.len - curI - 1] = num.buf.data[num.buf.len - 1] >> curBit;
-			
-			_utility::destroyAll(num.buf.data + num.buf.len - curI, num.buf.data + num.buf.len, num.allocator);
-			num.buf.len -= curI;
-			
+			// digits are filled from the highest bit of num, drop the unused low bits
+			num.shr(curI * ENTRY_SIZE + curBit, std::false_type{});
 			return std::move(num);
 		}
 		BI _finish() const &{
 			assert(num.buf.len == num.buf.cap);
-			if((curI == 0) && (curBit == 0)){
-				return num;
-			}
-			
-			Ele leftover = num.buf.data[num.buf.len - 1] >> curBit;
-			assert((leftover == 0) || (num.buf.len > curI));
-			assert((leftover > 0) || (num.buf.len > curI + 1));
-			SizeT _len = (leftover > 0)? (num.buf.len - curI): (num.buf.len - curI - 1);
-			
-			BI res(typename BI::NullTag{});
-			res.buf.setLen(_len);
-			res.buf.data = res.allocator.allocate(static_cast<std::size_t>(res.buf.cap));
-			SizeT i = 0;
-			try{
-				for(;i + curI < num.buf.len - 1;++i){
-					res.allocator.construct(res.buf.data + i, (num.buf.data[i + curI] >> curBit) | ((num.buf.data[i + curI + 1] & ((1 << curBit) - 1)) << (ENTRY_SIZE - curBit)));
-				}
-				if(leftover > 0){
-					i = res.buf.len - 1;
-					res.allocator.construct(res.buf.data + i, leftover);
-				}
-			}
-			catch(...){
-				_utility::destroyAll(res.buf.data, res.buf.data + i, res.allocator);
-				res.allocator.deallocate(res.buf.data, static_cast<std::size_t>(res.buf.cap));
-				res.buf.data = nullptr;
-				res.buf.zeroLen();
-				throw ;
-			}
-			
+			BI res = num;
+			res.shr(curI * ENTRY_SIZE + curBit, std::false_type{});
 			return res;
 		}
 	private:
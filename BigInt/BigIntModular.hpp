@@ -0,0 +1,115 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_INT_MODULAR_HPP_
+#define _BIG_INT_MODULAR_HPP_
+
+#include <utility>
+
+#include "../Libs/BigNumWord.hpp"
+
+namespace bignum{
+	
+	namespace _type{
+		
+		// products modulo a fixed m, for the exponentiations. A ring keeps residues in
+		// its own Elem representation: convert() takes a BigInt in [0, m) there and
+		// recover() takes it back, while multiply() and square() may overwrite
+		// their operands.
+		
+		// residues modulo an odd m of n digits in Montgomery form x * beta^{n} mod m,
+		// as n digits each. Products are followed by a Montgomery reduction instead
+		// of a division, with the product and the Karatsuba scratch allocated once.
+		template <class BI>
+		class MontgomeryRing{
+		private:
+			using Ele = typename BI::Ele;
+			using SizeT = typename BI::SizeT;
+			using EleBuffer = typename BI::EleBuffer;
+		public:
+			using Elem = EleBuffer;
+			
+			explicit MontgomeryRing(const BI &_m)
+				:mod(_m), n(_m.buf.len), mInv(Ele(0) - _utility::inverseWord(_m.buf.data[0])),
+				threshold(BI::basecaseThreshold()),
+				t(2 * n, Ele(0)), scratch(_utility::karatsubaScratchLen(n, threshold), Ele(0)){
+				assert(Ele(0) != (_m.buf.data[0] & Ele(1)));
+			}
+			
+			Elem convert(const BI &x) const{
+				BI y = x;
+				y.shl(n * BI::ENTRY_SIZE, std::false_type{});
+				y = std::move(y).modularBy(mod);
+				Elem res(n, Ele(0));
+				std::copy(y.buf.data, y.buf.data + y.buf.len, res.data());
+				return res;
+			}
+			BI recover(const Elem &x){
+				std::copy(x.data(), x.data() + n, t.data());
+				std::fill(t.data() + n, t.data() + 2 * n, Ele(0));
+				Elem res(n, Ele(0));
+				_utility::redcDigits(res.data(), t.data(), mod.buf.data, n, mInv);
+				return BI::fromDigits(res.data(), n);
+			}
+			Elem one() const{
+				return convert(BI(Ele(1)));
+			}
+			
+			// res = x * y, res may be x or y
+			void multiply(Elem &res, const Elem &x, const Elem &y){
+				if(&x == &y){
+					_utility::sqrKaratsuba(t.data(), x.data(), n, scratch.data(), threshold);
+				}
+				else{
+					_utility::mulKaratsuba(t.data(), x.data(), y.data(), n, scratch.data(), threshold);
+				}
+				_utility::redcDigits(res.data(), t.data(), mod.buf.data, n, mInv);
+			}
+			void square(Elem &x){
+				multiply(x, x, x);
+			}
+		private:
+			BI mod;
+			SizeT n;
+			Ele mInv;
+			SizeT threshold;
+			EleBuffer t, scratch;
+		};// class MontgomeryRing
+		
+		// residues modulo any m as BigInts, every product being reduced by a Divisor
+		template <class BI>
+		class DivisorRing{
+		private:
+			using Ele = typename BI::Ele;
+		public:
+			using Elem = BI;
+			
+			explicit DivisorRing(const BI &_m)
+				:dv(_m){}
+			
+			Elem convert(const BI &x) const{
+				return x;
+			}
+			BI recover(const Elem &x) const{
+				return x;
+			}
+			Elem one(){
+				return dv.mod(BI(Ele(1)));
+			}
+			
+			void multiply(Elem &res, const Elem &x, const Elem &y){
+				res = dv.mod(x * y);
+			}
+			void square(Elem &x){
+				x.square();
+				x = dv.mod(std::move(x));
+			}
+		private:
+			typename BI::Divisor dv;
+		};// class DivisorRing
+	
+	};// namespace _type
+	
+};// namespace bignum
+#endif // _BIG_INT_MODULAR_HPP_
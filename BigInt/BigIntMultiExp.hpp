@@ -0,0 +1,210 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_INT_MULTI_EXP_HPP_
+#define _BIG_INT_MULTI_EXP_HPP_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "../Libs/BigNumThread.hpp"
+#include "BigIntModular.hpp"
+
+namespace bignum{
+	
+	namespace _type{
+		
+		// products of powers prod g[i] ^ e[i] in ring, for 0 <= g[i] < m and e[i] > 0.
+		// Both methods share the squarings among all the powers.
+		template <class BI, class Ring>
+		class MultiExp{
+		private:
+			using Elem = typename Ring::Elem;
+			using Ele = typename BI::Ele;
+			using SizeT = typename BI::SizeT;
+			using LogSizeT = typename BI::LogSizeT;
+			
+			// bits [p, p + c) of a non-negative _exp, c < ENTRY_SIZE
+			static SizeT bitsAt(const BI &_exp, SizeT p, LogSizeT c) noexcept{
+				SizeT idx = p / BI::ENTRY_SIZE;
+				LogSizeT off = static_cast<LogSizeT>(p % BI::ENTRY_SIZE);
+				if(idx >= _exp.buf.len){
+					return 0;
+				}
+				Ele w = _exp.buf.data[idx] >> off;
+				if((off + c > BI::ENTRY_SIZE) && (idx + 1 < _exp.buf.len)){
+					w |= _exp.buf.data[idx + 1] << (BI::ENTRY_SIZE - off);
+				}
+				return static_cast<SizeT>(w & ((Ele(1) << c) - 1));
+			}
+			
+			// acc = acc * x, or acc = x for the first factor
+			static void accumulate(Ring &ring, Elem &acc, bool &started, const Elem &x){
+				if(started){
+					ring.multiply(acc, acc, x);
+				}
+				else{
+					acc = x;
+					started = true;
+				}
+			}
+		public:
+			// Straus' interleaved exponentiation: every base has its table of odd
+			// powers and its sliding windows as in powmod, and a single chain of
+			// squarings runs over the longest exponent, multiplying by a table entry
+			// wherever a window of any base ends.
+			static BI straus(Ring &ring, const std::vector<BI> &g, const std::vector<const BI *> &e){
+				SizeT n = static_cast<SizeT>(g.size());
+				std::vector<std::vector<Elem>> tables(n);
+				// (lowest bit, table index) of every window from the top
+				std::vector<std::vector<std::pair<SizeT, SizeT>>> windows(n);
+				SizeT top(0);
+				for(SizeT i = 0;i < n;++i){
+					const BI &_exp = *e[i];
+					SizeT bits = _exp.lenOfBinary();
+					top = std::max(top, bits);
+					LogSizeT k = BI::powWindowSize(bits);
+					
+					for(SizeT p = bits;p > 0;){
+						if(0 == bitsAt(_exp, p - 1, 1)){
+							--p;
+							continue;
+						}
+						SizeT j = (p > k)? (p - k): SizeT(0);
+						for(;0 == bitsAt(_exp, j, 1);++j){}
+						windows[i].emplace_back(j, bitsAt(_exp, j, static_cast<LogSizeT>(p - j)) >> 1);
+						p = j;
+					}
+					
+					SizeT cnt(0);
+					for(auto &w: windows[i]){
+						cnt = std::max(cnt, w.second + 1);
+					}
+					std::vector<Elem> &table = tables[i];
+					table.reserve(cnt);
+					table.push_back(ring.convert(g[i]));
+					if(cnt > 1){
+						Elem sq = table[0];
+						ring.square(sq);
+						for(SizeT j = 1;j < cnt;++j){
+							table.push_back(table[j - 1]);
+							ring.multiply(table[j], table[j], sq);
+						}
+					}
+				}
+				
+				std::vector<SizeT> next(n, 0);
+				Elem acc;
+				bool started = false;
+				for(SizeT p = top;p > 0;--p){
+					if(started){
+						ring.square(acc);
+					}
+					for(SizeT i = 0;i < n;++i){
+						if((next[i] < windows[i].size()) && (p - 1 == windows[i][next[i]].first)){
+							accumulate(ring, acc, started, tables[i][windows[i][next[i]].second]);
+							++next[i];
+						}
+					}
+				}
+				return ring.recover(started? acc: ring.one());
+			}
+			
+			// Pippenger's bucket method: the exponents are cut into c-bit windows, and
+			// for every window the bases are multiplied into the bucket of their
+			// digit d, whose product B[d] is raised to d by running products,
+			// prod B[d] ^ d = prod_{d} prod_{d' >= d} B[d']. The windows are then
+			// combined by c squarings each. Windows are independent, so they are
+			// spread over threads, each with a copy of ring.
+			static BI pippenger(Ring &ring, const std::vector<BI> &g, const std::vector<const BI *> &e){
+				SizeT n = static_cast<SizeT>(g.size());
+				SizeT top(0);
+				for(const BI *_exp: e){
+					top = std::max(top, _exp->lenOfBinary());
+				}
+				
+				// about top / c * (n + 2^{c + 1}) multiplications
+				LogSizeT c = 1;
+				for(LogSizeT t = 2;t <= 16;++t){
+					double cur = double((top + t - 1) / t) * (double(n) + double(SizeT(2) << t));
+					double best = double((top + c - 1) / c) * (double(n) + double(SizeT(2) << c));
+					if(cur < best){
+						c = t;
+					}
+				}
+				SizeT windowCnt = (top + c - 1) / c;
+				
+				std::vector<Elem> conv;
+				conv.reserve(n);
+				for(const BI &x: g){
+					conv.push_back(ring.convert(x));
+				}
+				
+				std::vector<Elem> sums(windowCnt);
+				std::vector<char> nonEmpty(windowCnt, 0);
+				auto window = [&](Ring &r, SizeT t){
+					SizeT bucketCnt = (SizeT(1) << c) - 1;
+					std::vector<Elem> buckets(bucketCnt);
+					std::vector<char> filled(bucketCnt, 0);
+					for(SizeT i = 0;i < n;++i){
+						SizeT d = bitsAt(*e[i], t * c, c);
+						if(0 != d){
+							bool started = (0 != filled[d - 1]);
+							accumulate(r, buckets[d - 1], started, conv[i]);
+							filled[d - 1] = 1;
+						}
+					}
+					
+					Elem running, sum;
+					bool hasRunning = false, hasSum = false;
+					for(SizeT d = bucketCnt;d > 0;--d){
+						if(0 != filled[d - 1]){
+							accumulate(r, running, hasRunning, buckets[d - 1]);
+						}
+						if(hasRunning){
+							accumulate(r, sum, hasSum, running);
+						}
+					}
+					if(hasSum){
+						sums[t] = std::move(sum);
+						nonEmpty[t] = 1;
+					}
+				};
+				
+				std::size_t threads = std::min<std::size_t>(_utility::getThreadCount(), windowCnt);
+				if(threads > 1){
+					_utility::parallelFor(threads, threads, [&](std::size_t id){
+						Ring local(ring);
+						for(SizeT t = static_cast<SizeT>(id);t < windowCnt;t += static_cast<SizeT>(threads)){
+							window(local, t);
+						}
+					});
+				}
+				else{
+					for(SizeT t = 0;t < windowCnt;++t){
+						window(ring, t);
+					}
+				}
+				
+				Elem acc;
+				bool started = false;
+				for(SizeT t = windowCnt;t > 0;--t){
+					if(started){
+						for(LogSizeT s = 0;s < c;++s){
+							ring.square(acc);
+						}
+					}
+					if(0 != nonEmpty[t - 1]){
+						accumulate(ring, acc, started, sums[t - 1]);
+					}
+				}
+				return ring.recover(started? acc: ring.one());
+			}
+		};// class MultiExp
+	
+	};// namespace _type
+	
+};// namespace bignum
+#endif // _BIG_INT_MULTI_EXP_HPP_
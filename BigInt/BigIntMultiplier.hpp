@@ -0,0 +1,75 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_INT_MULTIPLIER_HPP_
+#define _BIG_INT_MULTIPLIER_HPP_
+
+#include <type_traits>
+#include <utility>
+
+#include "../Libs/BigNumTypeTrait.hpp"
+
+namespace bignum{
+	
+	// a fixed factor that is multiplied by many other numbers. The forward transforms
+	// of the factor are computed on first use for each transform size and kept, so
+	// that a product only transforms the other operand, multiplies pointwise and
+	// transforms back. Products below the NTT threshold are done as usual.
+	// 
+	// multiply() updates the kept transforms, so an object must not be shared
+	// between threads without synchronization.
+	template <class BI>
+	class PreparedMultiplier{
+	private:
+		using TransformCache = typename BI::TransformCache;
+	public:
+		// transforms are keyed by the addresses of the digits, so a copy starts with
+		// none of them
+		PreparedMultiplier(const PreparedMultiplier &_rhs)
+			:num(_rhs.num), cache(){}
+		PreparedMultiplier(PreparedMultiplier &&) = default;
+		
+		PreparedMultiplier &operator=(const PreparedMultiplier &_rhs){
+			if(this != &_rhs){
+				num = _rhs.num;
+				cache.entries.clear();
+			}
+			return *this;
+		}
+		PreparedMultiplier &operator=(PreparedMultiplier &&_rhs){
+			if(this != &_rhs){
+				// the digits may be copied instead of taken over
+				num = std::move(_rhs.num);
+				cache.entries.clear();
+			}
+			return *this;
+		}
+		
+		~PreparedMultiplier() = default;
+		
+		template <class BIRef,
+			typename std::enable_if<isRLRef<BI, BIRef &&>::value>::type * = nullptr>
+		explicit PreparedMultiplier(BIRef &&_num)
+			:num(std::forward<BIRef>(_num)), cache(){}
+		
+		const BI &value() const noexcept{
+			return num;
+		}
+		
+		BI multiply(const BI &_rhs){
+			BI res(_rhs);
+			res.multiplyCached(num, &cache);
+			return res;
+		}
+		BI multiply(BI &&_rhs){
+			_rhs.multiplyCached(num, &cache);
+			return std::move(_rhs);
+		}
+	private:
+		BI num;
+		TransformCache cache;
+	};// class PreparedMultiplier
+	
+};// namespace bignum
+#endif // _BIG_INT_MULTIPLIER_HPP_
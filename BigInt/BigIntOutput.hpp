@@ -819,7 +819,8 @@ namespace bignum{
 			}
 			
 			LogSizeT highest = (lhs.buf.len * ENTRY_SIZE) % exp;
-			Ele highestLeft = lhs.buf.data[lhs.buf.len - 1] >> (ENTRY_SIZE - highest);
+			// avoid shifting a whole digit away when there are no leftover bits
+			Ele highestLeft = (highest == 0)? Ele(0): (lhs.buf.data[lhs.buf.len - 1] >> (ENTRY_SIZE - highest));
 			curI = lhs.buf.len - 1;
 			curBit = ENTRY_SIZE - highest;
 			if(highestLeft > 0){
@@ -828,12 +829,12 @@ namespace bignum{
 			do{
 				Ele digit = 0;
 				if(curBit >= exp){
-					digit = (lhs.buf.data[curI] >> (curBit - exp)) & ((1 << exp) - 1);
+					digit = (lhs.buf.data[curI] >> (curBit - exp)) & ((Ele(1) << exp) - 1);
 					curBit -= exp;
 				}
 				else{
 					assert(curI > 0);
-					digit = ((lhs.buf.data[curI] & ((1 << curBit) - 1)) << (exp - curBit)) | (lhs.buf.data[curI - 1] >> (curBit + ENTRY_SIZE - exp));
+					digit = ((lhs.buf.data[curI] & ((Ele(1) << curBit) - 1)) << (exp - curBit)) | (lhs.buf.data[curI - 1] >> (curBit + ENTRY_SIZE - exp));
 					curBit += ENTRY_SIZE - exp;
 					--curI;
 					assert(digit > 0);
@@ -849,12 +850,12 @@ namespace bignum{
 			
 			Ele digit = 0;
 			if(curBit >= exp){
-				digit = (lhs.buf.data[curI] >> (curBit - exp)) & ((1 << exp) - 1);
+				digit = (lhs.buf.data[curI] >> (curBit - exp)) & ((Ele(1) << exp) - 1);
 				curBit -= exp;
 			}
 			else{
 				assert(curI > 0);
-				digit = ((lhs.buf.data[curI] & ((1 << curBit) - 1)) << (exp - curBit)) | (lhs.buf.data[curI - 1] >> (curBit + ENTRY_SIZE - exp));
+				digit = ((lhs.buf.data[curI] & ((Ele(1) << curBit) - 1)) << (exp - curBit)) | (lhs.buf.data[curI - 1] >> (curBit + ENTRY_SIZE - exp));
 				curBit += ENTRY_SIZE - exp;
 				--curI;
 			}
@@ -140,19 +140,11 @@ namespace bignum{
 				typename std::iterator_traits<RndIter>::iterator_category{});
 		}*/
 		
-		template <typename Ring, typename InFunc, typename OutFunc>
-		inline static void fft1DPower2(std::size_t sizeN, Ring omega, InFunc &&getIn, OutFunc &&getOut){
-			assert((sizeN & ((~sizeN) + 1)) == sizeN);
-			
-			using std::pow;
+		// reorders getOut(0), ..., getOut(sizeN - 1) by bit-reversed indices
+		template <typename OutFunc>
+		inline static void bitReversePermute(std::size_t sizeN, OutFunc &&getOut){
 			using std::swap;
 			
-			using Ele = typename std::remove_reference<typename std::result_of<OutFunc(std::size_t)>::type>::type;
-			
-			for(std::size_t i = 0;i < sizeN;++i){
-				getOut(i) = getIn(i);
-			}
-			
 			std::size_t preRev = 0, rev;
 			for(std::size_t i = 1;i < sizeN;++i){
 				std::size_t tmp = sizeN >> 1;
@@ -166,6 +158,20 @@ namespace bignum{
 					swap(getOut(i), getOut(rev));
 				}
 			}
+		}
+		
+		template <typename Ring, typename InFunc, typename OutFunc>
+		inline static void fft1DPower2(std::size_t sizeN, Ring omega, InFunc &&getIn, OutFunc &&getOut){
+			assert((sizeN & ((~sizeN) + 1)) == sizeN);
+			
+			using std::pow;
+			
+			using Ele = typename std::remove_reference<typename std::result_of<OutFunc(std::size_t)>::type>::type;
+			
+			for(std::size_t i = 0;i < sizeN;++i){
+				getOut(i) = getIn(i);
+			}
+			bitReversePermute(sizeN, getOut);
 			
 			for(std::size_t m = 2;m <= sizeN;m <<= 1){
 				Ring w0 = pow(omega, sizeN / m);
@@ -5,7 +5,30 @@
 #ifndef _BIG_NUM_MODULAR_RING_HPP_
 #define _BIG_NUM_MODULAR_RING_HPP_
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
 #include "BigNumTypeTrait.hpp"
+#include "BigNumFFT.hpp"
+#include "BigNumSIMD.hpp"
+#include "BigNumThread.hpp"
+
+// transforms of at least this many points are spread over threads
+#ifndef _BIG_NUM_NTT_PARALLEL_THRESHOLD_
+#define _BIG_NUM_NTT_PARALLEL_THRESHOLD_ 65536
+#endif // _BIG_NUM_NTT_PARALLEL_THRESHOLD_
+// the number of points (a power of 2) transformed at a time to stay in cache
+#ifndef _BIG_NUM_NTT_BLOCK_SIZE_
+#define _BIG_NUM_NTT_BLOCK_SIZE_ 16384
+#endif // _BIG_NUM_NTT_BLOCK_SIZE_
 
 namespace bignum{
 	
@@ -24,10 +47,27 @@ namespace bignum{
 			}
 		};*/
 		
+		// elements are kept in [0, P). Additions and subtractions are reduced by a
+		// conditional subtraction instead of a modulo. Multiplications by a fixed
+		// element (e.g. twiddle factors) can go through Shoup's precomputed quotient,
+		// which leaves the result lazily in [0, 2P).
 		template <typename SizeT, typename Ele, SizeT P, Ele OMEGA>
 		class ModularP{
 		private:
 			using SqrEle = typename _type::squareType<Ele>::type;
+			
+			static constexpr int BITS = std::numeric_limits<Ele>::digits;
+			static_assert(P <= (std::numeric_limits<Ele>::max() >> 1), "2P must fit in Ele for lazy reduction");
+			
+			struct Reduced{};
+			constexpr ModularP(Ele _num, Reduced)
+				:num(_num){}
+			
+			// [0, 2P) -> [0, P). Conditional subtractions are done by masks, as branches
+			// on residues are unpredictable.
+			inline static constexpr Ele reduceOnce(Ele x){
+				return Ele(x - (P & Ele(0 - Ele(x >= P))));
+			}
 		public:
 			constexpr ModularP(Ele _num)
 				:num(_num % P){}
@@ -37,45 +77,85 @@ namespace bignum{
 			}
 			
 			constexpr ModularP &operator+=(const ModularP &_rhs){
-				num = (num + _rhs.num) % P;
+				num = reduceOnce(Ele(num + _rhs.num));
 				return *this;
 			}
 			friend constexpr ModularP operator+(const ModularP &_lhs, const ModularP &_rhs){
-				return ModularP((_lhs.num + _rhs.num) % P);
+				return ModularP(reduceOnce(Ele(_lhs.num + _rhs.num)), Reduced{});
 			}
 			friend constexpr ModularP operator+(const ModularP &_lhs, Ele _rhs){
-				return ModularP((_lhs.num + _rhs % P) % P);
+				return _lhs + ModularP(_rhs);
 			}
 			friend constexpr ModularP operator+(Ele _lhs, const ModularP &_rhs){
-				return ModularP((_lhs % P + _rhs.num) % P);
+				return ModularP(_lhs) + _rhs;
 			}
 			
 			constexpr ModularP &operator-=(const ModularP &_rhs){
-				num = (P - _rhs.num + num) % P;
+				num = reduceOnce(Ele(num + (P - _rhs.num)));
 				return *this;
 			}
 			friend constexpr ModularP operator-(const ModularP &_lhs, const ModularP &_rhs){
-				return ModularP((P - _rhs.num + _lhs.num) % P);
+				return ModularP(reduceOnce(Ele(_lhs.num + (P - _rhs.num))), Reduced{});
 			}
 			friend constexpr ModularP operator-(const ModularP &_lhs, Ele _rhs){
-				return ModularP((P - _rhs % P + _lhs.num) % P);
+				return _lhs - ModularP(_rhs);
 			}
 			friend constexpr ModularP operator-(Ele _lhs, const ModularP &_rhs){
-				return ModularP((P - _rhs.num + _lhs % P) % P);
+				return ModularP(_lhs) - _rhs;
 			}
 			
+			// P is a compile-time constant, so the modulo of a product compiles to a
+			// multiplication by its reciprocal rather than a division
 			constexpr ModularP &operator*=(const ModularP &_rhs){
 				num = static_cast<Ele>((static_cast<SqrEle>(num) * static_cast<SqrEle>(_rhs.num)) % P);
 				return *this;
 			}
 			friend constexpr ModularP operator*(const ModularP &_lhs, const ModularP &_rhs){
-				return ModularP(static_cast<Ele>((static_cast<SqrEle>(_lhs.num) * static_cast<SqrEle>(_rhs.num)) % P));
+				return ModularP(static_cast<Ele>((static_cast<SqrEle>(_lhs.num) * static_cast<SqrEle>(_rhs.num)) % P), Reduced{});
 			}
 			friend constexpr ModularP operator*(const ModularP &_lhs, Ele _rhs){
-				return ModularP(static_cast<Ele>((static_cast<SqrEle>(_lhs.num) * static_cast<SqrEle>(_rhs % P)) % P));
+				return _lhs * ModularP(_rhs);
 			}
 			friend constexpr ModularP operator*(Ele _lhs, const ModularP &_rhs){
-				return ModularP(static_cast<Ele>((static_cast<SqrEle>(_lhs % P) * static_cast<SqrEle>(_rhs.num)) % P));
+				return ModularP(_lhs) * _rhs;
+			}
+			
+			// multiplication by a fixed element w with w' = floor(w * 2^BITS / P). For any
+			// y, w * y - floor(w' * y / 2^BITS) * P lies in [0, 2P).
+			class Shoup{
+			public:
+				explicit constexpr Shoup(const ModularP &_w)
+					:w(_w.num), wq(static_cast<Ele>((static_cast<SqrEle>(_w.num) << BITS) / P)){}
+				
+				constexpr Ele mulLazy(Ele y) const{
+					return mulLazy(w, wq, y);
+				}
+				inline static constexpr Ele mulLazy(Ele w, Ele wq, Ele y){
+					return static_cast<Ele>(static_cast<SqrEle>(w) * y 
+						- ((static_cast<SqrEle>(wq) * y) >> BITS) * P);
+				}
+				
+				constexpr Ele value() const{
+					return w;
+				}
+				constexpr Ele quotient() const{
+					return wq;
+				}
+			private:
+				Ele w, wq;
+			};
+			
+			// operations on lazily reduced values in [0, 2P)
+			inline static constexpr Ele lazyAdd(Ele x, Ele y){
+				return static_cast<Ele>(static_cast<SqrEle>(x) + y 
+					- (2 * static_cast<SqrEle>(P) & SqrEle(0 - SqrEle(static_cast<SqrEle>(x) + y >= 2 * static_cast<SqrEle>(P)))));
+			}
+			inline static constexpr Ele lazySub(Ele x, Ele y){
+				return static_cast<Ele>(static_cast<SqrEle>(x) - y 
+					+ (2 * static_cast<SqrEle>(P) & SqrEle(0 - SqrEle(x < y))));
+			}
+			inline static constexpr Ele lazyNormalize(Ele x){
+				return reduceOnce(x);
 			}
 			
 			friend constexpr ModularP pow(const ModularP &base, std::size_t exp){
@@ -139,6 +219,441 @@ namespace bignum{
 			Ele num;
 		};
 		
+		template <class Ring>
+		class NTTPlan;
+		
+		// sizeN-point transforms over a prime field. Butterflies keep their values
+		// lazily in [0, 2P), so there is no modulo in the inner loop. Outputs are
+		// fully reduced.
+		// 
+		// The factors of a pass only depend on its width and on the root, so the
+		// twiddles live in one table per root, which grows to the largest transform
+		// so far and is shared by the plans of every size. A plan itself only keeps
+		// its size and 1/sizeN, and the bit reversal is computed as it goes. Plans
+		// are cached for the whole program by get(), which is safe to call from
+		// several threads.
+		template <typename SizeT, typename Ele, SizeT P, Ele OMEGA>
+		class NTTPlan<ModularP<SizeT, Ele, P, OMEGA>>{
+		private:
+			using Ring = ModularP<SizeT, Ele, P, OMEGA>;
+			using Shoup = typename Ring::Shoup;
+			
+			// w[mh, 2 * mh) holds the mh factors of the pass over 2 * mh points and
+			// wq[mh, 2 * mh) their Shoup quotients
+			struct Twiddles{
+				std::vector<Ele> w, wq;
+			};
+			
+			// the twiddles of a primitive order-th root of unity omega, whose pass over
+			// 2 * mh points uses the powers of omega ^ {order / (2 * mh)}
+			class TwiddleTable{
+			public:
+				TwiddleTable(Ring _omega, std::size_t _order)
+					:omega(_omega), order(_order), current(std::make_shared<Twiddles>()){
+					current->w.push_back(Ele(0));
+					current->wq.push_back(Ele(0));
+				}
+				
+				// a table covering the passes of sizeN-point transforms. Growing it
+				// replaces the table, and transforms still running on the old one keep
+				// it until they are done.
+				std::shared_ptr<const Twiddles> get(std::size_t sizeN){
+					std::lock_guard<std::mutex> guard(lock);
+					if(current->w.size() < sizeN){
+						std::shared_ptr<Twiddles> next = std::make_shared<Twiddles>();
+						next->w.reserve(sizeN);
+						next->wq.reserve(sizeN);
+						next->w = current->w;
+						next->wq = current->wq;
+						// w.size() is always the width mh of the next pass
+						for(std::size_t mh = next->w.size();mh < sizeN;mh <<= 1){
+							Ring w0 = pow(omega, order / (mh << 1));
+							Ring w(1);
+							for(std::size_t i = 0;i < mh;++i){
+								Shoup ws(w);
+								next->w.push_back(ws.value());
+								next->wq.push_back(ws.quotient());
+								w *= w0;
+							}
+						}
+						current = std::move(next);
+					}
+					return current;
+				}
+				
+				inline static TwiddleTable &of(Ring omega, std::size_t order){
+					static std::mutex tablesLock;
+					static std::map<std::pair<Ele, std::size_t>, std::unique_ptr<TwiddleTable>> tables;
+					
+					std::lock_guard<std::mutex> guard(tablesLock);
+					std::unique_ptr<TwiddleTable> &table = tables[std::make_pair(Ele(omega), order)];
+					if(!table){
+						table.reset(new TwiddleTable(omega, order));
+					}
+					return *table;
+				}
+			private:
+				Ring omega;
+				std::size_t order;
+				std::mutex lock;
+				std::shared_ptr<Twiddles> current;
+			};
+			
+			// the 32-bit vector kernels apply to residues of Ele = uint32_t
+			using UseSIMD = std::integral_constant<bool, std::is_same<Ele, std::uint32_t>::value>;
+		public:
+			// omega is a primitive order-th root of unity, order being a multiple of sizeN
+			NTTPlan(std::size_t _sizeN, Ring omega, std::size_t order)
+				:sizeN(_sizeN), 
+				forwardTable(&TwiddleTable::of(omega, order)), 
+				inverseTable(&TwiddleTable::of(pow(omega, order - 1), order)), 
+				scale(Ring(1)){
+				assert((sizeN & ((~sizeN) + 1)) == sizeN);
+				assert(order % sizeN == 0);
+				
+				// (P + 1) / 2 is the inverse of 2
+				Ring half(Ele((P >> 1) + 1)), invN(1);
+				for(std::size_t n = 1;n < sizeN;n <<= 1){
+					invN *= half;
+				}
+				scale = Shoup(invN);
+			}
+			
+			inline static const NTTPlan &get(std::size_t sizeN, Ring omega, std::size_t order){
+				static std::mutex lock;
+				static std::map<std::pair<std::size_t, Ele>, std::unique_ptr<NTTPlan>> plans;
+				
+				std::lock_guard<std::mutex> guard(lock);
+				std::unique_ptr<NTTPlan> &plan = plans[std::make_pair(sizeN, Ele(omega))];
+				if(!plan){
+					plan.reset(new NTTPlan(sizeN, omega, order));
+				}
+				return *plan;
+			}
+			
+			std::size_t size() const noexcept{
+				return sizeN;
+			}
+			
+			template <typename InFunc, typename OutFunc>
+			void forward(InFunc &&getIn, OutFunc &&getOut) const{
+				load(getIn, getOut);
+				butterflies(*forwardTable->get(sizeN), getOut);
+				for(std::size_t i = 0;i < sizeN;++i){
+					getOut(i) = Ring::lazyNormalize(getOut(i));
+				}
+			}
+			// out[0, sizeN) is contiguous, which allows vectorized butterflies. Large
+			// transforms are also spread over threads, so getIn has to be safe to call
+			// concurrently.
+			template <typename InFunc>
+			void forward(InFunc &&getIn, Ele *out) const{
+				std::size_t threads = parallelism();
+				forChunks(threads, [this, &getIn, out](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						out[i] = Ele(Ring(getIn(i)));
+					}
+				});
+				permute(threads, out);
+				butterflies<false>(*forwardTable->get(sizeN), out, threads);
+				forChunks(threads, [out](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						out[i] = Ring::lazyNormalize(out[i]);
+					}
+				});
+			}
+			// in place on data[0, sizeN), whose elements are already reduced
+			void forward(Ele *data) const{
+				std::size_t threads = parallelism();
+				permute(threads, data);
+				butterflies<false>(*forwardTable->get(sizeN), data, threads);
+				forChunks(threads, [data](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						data[i] = Ring::lazyNormalize(data[i]);
+					}
+				});
+			}
+			
+			// inverse transform, including the multiplication of 1/sizeN
+			template <typename InFunc, typename OutFunc>
+			void inverse(InFunc &&getIn, OutFunc &&getOut) const{
+				load(getIn, getOut);
+				butterflies(*inverseTable->get(sizeN), getOut);
+				for(std::size_t i = 0;i < sizeN;++i){
+					getOut(i) = Ring::lazyNormalize(scale.mulLazy(getOut(i)));
+				}
+			}
+			// in place on data[0, sizeN), whose elements are already reduced
+			void inverse(Ele *data) const{
+				std::size_t threads = parallelism();
+				permute(threads, data);
+				inverseDIT(data);
+			}
+			
+			// A convolution does not need its spectra in natural order. forwardDIF
+			// transforms natural-order input by decimation in frequency and leaves the
+			// spectrum in bit-reversed order, which inverseDIT takes back by decimation
+			// in time, so neither permutes.
+			template <typename InFunc>
+			void forwardDIF(InFunc &&getIn, Ele *out) const{
+				forChunks(parallelism(), [&getIn, out](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						out[i] = Ele(Ring(getIn(i)));
+					}
+				});
+				forwardDIF(out);
+			}
+			void forwardDIF(Ele *data) const{
+				std::size_t threads = parallelism();
+				butterflies<true>(*forwardTable->get(sizeN), data, threads);
+				forChunks(threads, [data](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						data[i] = Ring::lazyNormalize(data[i]);
+					}
+				});
+			}
+			void inverseDIT(Ele *data) const{
+				std::size_t threads = parallelism();
+				butterflies<false>(*inverseTable->get(sizeN), data, threads);
+				forChunks(threads, [this, data](std::size_t first, std::size_t last){
+					for(std::size_t i = first;i < last;++i){
+						data[i] = Ring::lazyNormalize(scale.mulLazy(data[i]));
+					}
+				});
+			}
+			
+			// _lhs[i] = _lhs[i] * _rhs[i] for i < n
+			inline static void multiplyPointwise(Ele *_lhs, const Ele *_rhs, std::size_t n){
+				std::size_t threads = (n >= _BIG_NUM_NTT_PARALLEL_THRESHOLD_)? getThreadCount(): 1;
+				parallelFor(threads, threads, [_lhs, _rhs, n, threads](std::size_t t){
+					std::size_t first = n * t / threads, last = n * (t + 1) / threads;
+					std::size_t i = first + multiplyPointwiseSIMD(_lhs + first, _rhs + first, last - first, UseSIMD{});
+					for(;i < last;++i){
+						_lhs[i] = Ele(Ring(_lhs[i]) * Ring(_rhs[i]));
+					}
+				});
+			}
+		private:
+			// i with its log2(sizeN) bits reversed
+			std::size_t reversedIndex(std::size_t i) const noexcept{
+				std::size_t r = 0;
+				for(std::size_t bit = sizeN >> 1;bit != 0;bit >>= 1, i >>= 1){
+					r |= (i & 1)? bit: 0;
+				}
+				return r;
+			}
+			// the index after r in bit-reversed order
+			std::size_t nextReversed(std::size_t r) const noexcept{
+				std::size_t bit = sizeN >> 1;
+				for(;(r & bit) != 0;bit >>= 1){
+					r ^= bit;
+				}
+				return r | bit;
+			}
+			
+			// getIn and getOut may refer to the same storage
+			template <typename InFunc, typename OutFunc>
+			void load(InFunc &&getIn, OutFunc &&getOut) const{
+				using std::swap;
+				
+				for(std::size_t i = 0;i < sizeN;++i){
+					getOut(i) = Ele(Ring(getIn(i)));
+				}
+				for(std::size_t i = 1, r = nextReversed(0);i < sizeN;++i, r = nextReversed(r)){
+					if(i < r){
+						swap(getOut(i), getOut(r));
+					}
+				}
+			}
+			
+			template <typename OutFunc>
+			void butterflies(const Twiddles &twiddles, OutFunc &&getOut) const{
+				for(std::size_t mh = 1;mh < sizeN;mh <<= 1){
+					const Ele *w = twiddles.w.data() + mh, *wq = twiddles.wq.data() + mh;
+					for(std::size_t j = 0;j < sizeN;j += (mh << 1)){
+						for(std::size_t i = 0;i < mh;++i){
+							Ele x = getOut(j + i);
+							Ele t = Shoup::mulLazy(w[i], wq[i], getOut(j + i + mh));
+							getOut(j + i) = Ring::lazyAdd(x, t);
+							getOut(j + i + mh) = Ring::lazySub(x, t);
+						}
+					}
+				}
+			}
+			// the number of threads for a transform
+			std::size_t parallelism() const{
+				return (sizeN < _BIG_NUM_NTT_PARALLEL_THRESHOLD_)? 1: getThreadCount();
+			}
+			
+			// func(first, last) over threads consecutive ranges covering [0, sizeN)
+			template <typename Func>
+			void forChunks(std::size_t threads, Func &&func) const{
+				parallelFor(threads, threads, [this, threads, &func](std::size_t t){
+					func(sizeN * t / threads, sizeN * (t + 1) / threads);
+				});
+			}
+			
+			// each swap is done by the smaller of its two indices, so chunks never touch
+			// the same pair
+			void permute(std::size_t threads, Ele *data) const{
+				forChunks(threads, [this, data](std::size_t first, std::size_t last){
+					using std::swap;
+					
+					if(first >= last){
+						return ;
+					}
+					for(std::size_t i = first, r = reversedIndex(first);;r = nextReversed(r)){
+						if(i < r){
+							swap(data[i], data[r]);
+						}
+						if(++i == last){
+							break;
+						}
+					}
+				});
+			}
+			
+			// Passes are blocked to stay in cache. Those narrower than blockN only mix
+			// points inside independent blockN-point blocks, which are transformed one
+			// at a time. The wider ones are grouped so that, within a group starting at
+			// mh = M, point i only meets points congruent to i modulo M. Every group
+			// then works on tiles of TILE_WIDTH consecutive columns over blockN /
+			// TILE_WIDTH rows, which again fit in cache. Blocks and tiles are spread
+			// over threads.
+			// 
+			// Decimation in time goes from the narrowest pass up and DIF from the
+			// widest down, so the order of the blocks and groups is reversed for it.
+			template <bool DIF>
+			void butterflies(const Twiddles &twiddles, Ele *data, std::size_t threads) const{
+				constexpr std::size_t TILE_WIDTH = 64;
+				
+				if(sizeN < 2){
+					return ;
+				}
+				std::size_t blockN = 2;
+				for(;((blockN << 1) <= sizeN) && ((blockN << 1) <= std::size_t(_BIG_NUM_NTT_BLOCK_SIZE_));blockN <<= 1){}
+				
+				auto blocks = [this, &twiddles, data, blockN, threads](){
+					parallelFor(sizeN / blockN, threads, [this, &twiddles, data, blockN](std::size_t b){
+						Ele *block = data + b * blockN;
+						std::size_t width = registerPasses(blockN, UseSIMD{});
+						if(DIF){
+							for(std::size_t mh = blockN >> 1;mh >= width;mh >>= 1){
+								pass<DIF>(twiddles, block, blockN, mh, 0, mh, UseSIMD{});
+							}
+							smallPasses<DIF>(twiddles, block, blockN, width, UseSIMD{});
+						}
+						else{
+							smallPasses<DIF>(twiddles, block, blockN, width, UseSIMD{});
+							for(std::size_t mh = width;mh < blockN;mh <<= 1){
+								pass<DIF>(twiddles, block, blockN, mh, 0, mh, UseSIMD{});
+							}
+						}
+					});
+				};
+				
+				std::size_t width = std::min(TILE_WIDTH, blockN >> 1), rows = blockN / width;
+				std::vector<std::size_t> groups;
+				for(std::size_t M = blockN;M < sizeN;M *= rows){
+					groups.push_back(M);
+				}
+				if(DIF){
+					std::reverse(groups.begin(), groups.end());
+				}
+				else{
+					blocks();
+				}
+				for(std::size_t M: groups){
+					std::size_t groupN = std::min(M * rows, sizeN), tiles = M / width;
+					parallelFor((sizeN / groupN) * tiles, threads, 
+						[this, &twiddles, data, width, M, groupN, tiles](std::size_t task){
+						Ele *group = data + (task / tiles) * groupN;
+						std::size_t col = (task % tiles) * width;
+						for(std::size_t k = M;k < groupN;k <<= 1){
+							// DIF walks the same passes backwards
+							std::size_t mh = DIF? (groupN / (k / M) / 2): k;
+							for(std::size_t q = col;q < mh;q += M){
+								pass<DIF>(twiddles, group, groupN, mh, q, q + width, UseSIMD{});
+							}
+						}
+					});
+				}
+				if(DIF){
+					blocks();
+				}
+			}
+			
+			// the width below which passes over an n-point block are done in registers
+			// by smallPasses, or 1 if they are not
+			std::size_t registerPasses(std::size_t n, std::true_type) const{
+				std::size_t lanes = simdLanes32();
+				return ((0 == lanes) || (n < lanes))? 1: lanes;
+			}
+			std::size_t registerPasses(std::size_t, std::false_type) const{
+				return 1;
+			}
+			template <bool DIF>
+			void smallPasses(const Twiddles &twiddles, Ele *data, std::size_t n, std::size_t width, std::true_type) const{
+				if(width > 1){
+					nttSmallPassesSIMD<DIF>(data, n, twiddles.w.data(), twiddles.wq.data(), P);
+				}
+			}
+			template <bool DIF>
+			void smallPasses(const Twiddles &, Ele *, std::size_t, std::size_t, std::false_type) const{}
+			
+			// the butterflies (j + i, j + i + mh) with first <= i < last of the pass over
+			// 2 * mh points in an n-point transform
+			template <bool DIF>
+			void pass(const Twiddles &twiddles, Ele *data, std::size_t n, std::size_t mh, 
+				std::size_t first, std::size_t last, std::true_type) const{
+				std::size_t lanes = simdLanes32();
+				if((0 != lanes) && (first % lanes == 0) && (last % lanes == 0) && 
+					nttPassSIMD<DIF>(data, n, mh, first, last, twiddles.w.data(), twiddles.wq.data(), P)){
+					return ;
+				}
+				pass<DIF>(twiddles, data, n, mh, first, last, std::false_type{});
+			}
+			template <bool DIF>
+			void pass(const Twiddles &twiddles, Ele *data, std::size_t n, std::size_t mh, 
+				std::size_t first, std::size_t last, std::false_type) const{
+				const Ele *w = twiddles.w.data() + mh, *wq = twiddles.wq.data() + mh;
+				for(std::size_t j = 0;j < n;j += (mh << 1)){
+					for(std::size_t i = first;i < last;++i){
+						Ele x = data[j + i];
+						Ele y = data[j + i + mh];
+						if(DIF){
+							data[j + i] = Ring::lazyAdd(x, y);
+							data[j + i + mh] = Shoup::mulLazy(w[i], wq[i], Ring::lazySub(x, y));
+						}
+						else{
+							Ele t = Shoup::mulLazy(w[i], wq[i], y);
+							data[j + i] = Ring::lazyAdd(x, t);
+							data[j + i + mh] = Ring::lazySub(x, t);
+						}
+					}
+				}
+			}
+			
+			inline static std::size_t multiplyPointwiseSIMD(Ele *_lhs, const Ele *_rhs, std::size_t n, std::true_type){
+				return mulPointwiseSIMD(_lhs, _rhs, n, P);
+			}
+			inline static std::size_t multiplyPointwiseSIMD(Ele *, const Ele *, std::size_t, std::false_type){
+				return 0;
+			}
+			
+			std::size_t sizeN;
+			TwiddleTable *forwardTable, *inverseTable;
+			Shoup scale;
+		};
+		
+		// fft1DPower2 over a prime field, done by a cached NTTPlan
+		template <typename SizeT, typename Ele, SizeT P, Ele OMEGA, typename InFunc, typename OutFunc>
+		inline static void fft1DPower2(std::size_t sizeN, ModularP<SizeT, Ele, P, OMEGA> omega, 
+			InFunc &&getIn, OutFunc &&getOut){
+			NTTPlan<ModularP<SizeT, Ele, P, OMEGA>>::get(sizeN, omega, sizeN).forward(
+				std::forward<InFunc>(getIn), std::forward<OutFunc>(getOut));
+		}
+		
 	};// namespace _utility
 	
 }; // namespace bignum
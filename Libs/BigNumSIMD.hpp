@@ -0,0 +1,419 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_NUM_SIMD_HPP_
+#define _BIG_NUM_SIMD_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+// x86 vector kernels are compiled with per-function target attributes and picked
+// at runtime by CPUID, so the same binary still runs on hosts without them.
+// Define _BIG_NUM_NO_SIMD_ to always use the portable scalar code.
+#if !defined(_BIG_NUM_NO_SIMD_) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _BIG_NUM_X86_SIMD_
+#include <immintrin.h>
+#endif
+
+namespace bignum{
+
+	namespace _utility{
+
+		enum class SIMDLevel{
+			NONE,
+			AVX2,
+			AVX512
+		};
+
+		inline static SIMDLevel detectSIMDLevel() noexcept{
+#ifdef _BIG_NUM_X86_SIMD_
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx512f")){
+				return SIMDLevel::AVX512;
+			}
+			if(__builtin_cpu_supports("avx2")){
+				return SIMDLevel::AVX2;
+			}
+#endif // _BIG_NUM_X86_SIMD_
+			return SIMDLevel::NONE;
+		}
+		inline static SIMDLevel simdLevel() noexcept{
+			static const SIMDLevel level = detectSIMDLevel();
+			return level;
+		}
+
+		// the number of 32-bit lanes processed at once, or 0 for the scalar path
+		inline static std::size_t simdLanes32() noexcept{
+			switch(simdLevel()){
+			case SIMDLevel::AVX512:
+				return 16;
+			case SIMDLevel::AVX2:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+
+		// constants for Montgomery reduction modulo an odd p < 2 ^ 31 with R = 2 ^ 32:
+		// -p ^ {-1} mod R and R ^ 2 mod p
+		inline static std::uint32_t montgomeryNegInverse(std::uint32_t p) noexcept{
+			// p * p == 1 mod 8, and every Newton step doubles the correct bits
+			std::uint32_t inv = p;
+			for(int i = 0;i < 4;++i){
+				inv *= std::uint32_t(2) - p * inv;
+			}
+			return std::uint32_t(0) - inv;
+		}
+		inline static std::uint32_t montgomeryR2(std::uint32_t p) noexcept{
+			std::uint64_t r = (std::uint64_t(1) << 32) % p;
+			return static_cast<std::uint32_t>(r * r % p);
+		}
+
+#ifdef _BIG_NUM_X86_SIMD_
+
+		// All kernels work on residues modulo p < 2 ^ 31 kept lazily in [0, 2p), with
+		// twiddle factors w and their Shoup quotients wq = floor(w * 2 ^ 32 / p).
+
+		__attribute__((target("avx2")))
+		inline static __m256i mulShoupAVX2(__m256i w, __m256i wq, __m256i y, __m256i p){
+			__m256i qEven = _mm256_srli_epi64(_mm256_mul_epu32(wq, y), 32);
+			__m256i qOdd = _mm256_mul_epu32(_mm256_srli_epi64(wq, 32), _mm256_srli_epi64(y, 32));
+			__m256i q = _mm256_blend_epi32(qEven, qOdd, 0xAA);
+			return _mm256_sub_epi32(_mm256_mullo_epi32(w, y), _mm256_mullo_epi32(q, p));
+		}
+		// x + t and x - t in [0, 2p). x + t may not fit in 32 bits, so the sum is
+		// compared as x >= 2p - t.
+		__attribute__((target("avx2")))
+		inline static __m256i lazyAddAVX2(__m256i x, __m256i t, __m256i p2){
+			__m256i u = _mm256_sub_epi32(p2, t);
+			__m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(x, u), x);
+			return _mm256_blendv_epi8(_mm256_add_epi32(x, t), _mm256_sub_epi32(x, u), ge);
+		}
+		__attribute__((target("avx2")))
+		inline static __m256i lazySubAVX2(__m256i x, __m256i t, __m256i p2){
+			__m256i d = _mm256_sub_epi32(x, t);
+			__m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(x, t), x);
+			return _mm256_blendv_epi8(_mm256_add_epi32(d, p2), d, ge);
+		}
+
+		// the radix-2 pass over 2 * mh points of a sizeN-point transform, restricted to
+		// the butterflies (j + i, j + i + mh) with iBegin <= i < iEnd. w[mh, 2 * mh) and
+		// wq[mh, 2 * mh) hold the factors of the pass. iBegin and iEnd must be
+		// multiples of the vector width.
+		// 
+		// DIF selects the butterfly (x + y, (x - y) * w) of decimation in frequency
+		// instead of the (x + w * y, x - w * y) of decimation in time.
+		template <bool DIF>
+		__attribute__((target("avx2")))
+		inline static void nttPassAVX2(std::uint32_t *data, std::size_t sizeN, std::size_t mh,
+			std::size_t iBegin, std::size_t iEnd, const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+			const __m256i vp = _mm256_set1_epi32(static_cast<int>(p));
+			const __m256i vp2 = _mm256_set1_epi32(static_cast<int>(2 * p));
+
+			for(std::size_t j = 0;j < sizeN;j += (mh << 1)){
+				std::uint32_t *lo = data + j, *hi = data + (j + mh);
+				for(std::size_t i = iBegin;i < iEnd;i += 8){
+					__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lo + i));
+					__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hi + i));
+					__m256i vw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(w + mh + i));
+					__m256i vwq = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(wq + mh + i));
+					if(DIF){
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(lo + i), lazyAddAVX2(x, y, vp2));
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(hi + i), mulShoupAVX2(vw, vwq, lazySubAVX2(x, y, vp2), vp));
+					}
+					else{
+						__m256i t = mulShoupAVX2(vw, vwq, y, vp);
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(lo + i), lazyAddAVX2(x, t, vp2));
+						_mm256_storeu_si256(reinterpret_cast<__m256i *>(hi + i), lazySubAVX2(x, t, vp2));
+					}
+				}
+			}
+		}
+
+		// the passes with mh < 8 over data[0, n), n being a multiple of 8. They pair
+		// lanes of the same vector, so every lane takes its lower and upper partners
+		// by permutations, and the sum or difference is picked by its position.
+		// With DIF the passes run from the widest down.
+		template <bool DIF>
+		__attribute__((target("avx2")))
+		inline static void nttSmallPassesAVX2(std::uint32_t *data, std::size_t n,
+			const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+			const __m256i vp = _mm256_set1_epi32(static_cast<int>(p));
+			const __m256i vp2 = _mm256_set1_epi32(static_cast<int>(2 * p));
+
+			__m256i lo[3], hi[3], vw[3], vwq[3];
+			for(int k = 0;k < 3;++k){
+				int mh = 1 << k;
+				alignas(32) std::uint32_t loIdx[8], hiIdx[8], laneW[8], laneWq[8];
+				for(int l = 0;l < 8;++l){
+					loIdx[l] = static_cast<std::uint32_t>(l & ~mh);
+					hiIdx[l] = static_cast<std::uint32_t>(l | mh);
+					laneW[l] = w[mh + (l & (mh - 1))];
+					laneWq[l] = wq[mh + (l & (mh - 1))];
+				}
+				lo[k] = _mm256_load_si256(reinterpret_cast<const __m256i *>(loIdx));
+				hi[k] = _mm256_load_si256(reinterpret_cast<const __m256i *>(hiIdx));
+				vw[k] = _mm256_load_si256(reinterpret_cast<const __m256i *>(laneW));
+				vwq[k] = _mm256_load_si256(reinterpret_cast<const __m256i *>(laneWq));
+			}
+
+			for(std::size_t i = 0;i < n;i += 8){
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+				for(int s = 0;s < 3;++s){
+					int k = DIF? (2 - s): s;
+					__m256i x = _mm256_permutevar8x32_epi32(v, lo[k]);
+					__m256i y = _mm256_permutevar8x32_epi32(v, hi[k]);
+					__m256i sum, diff;
+					if(DIF){
+						sum = lazyAddAVX2(x, y, vp2);
+						diff = mulShoupAVX2(vw[k], vwq[k], lazySubAVX2(x, y, vp2), vp);
+					}
+					else{
+						__m256i t = mulShoupAVX2(vw[k], vwq[k], y, vp);
+						sum = lazyAddAVX2(x, t, vp2);
+						diff = lazySubAVX2(x, t, vp2);
+					}
+					switch(k){
+					case 0:
+						v = _mm256_blend_epi32(sum, diff, 0xAA);
+						break;
+					case 1:
+						v = _mm256_blend_epi32(sum, diff, 0xCC);
+						break;
+					default:
+						v = _mm256_blend_epi32(sum, diff, 0xF0);
+						break;
+					}
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), v);
+			}
+		}
+
+		// REDC on the low 32-bit halves of 64-bit lanes holding t < p * 2 ^ 32, giving
+		// t / 2 ^ 32 mod p in [0, 2p)
+		__attribute__((target("avx2")))
+		inline static __m256i redcAVX2(__m256i t, __m256i p, __m256i pInv){
+			__m256i m = _mm256_mul_epu32(t, pInv);
+			return _mm256_srli_epi64(_mm256_add_epi64(t, _mm256_mul_epu32(m, p)), 32);
+		}
+
+		// lhs[i] = lhs[i] * rhs[i] mod p for i < n, by two Montgomery reductions
+		__attribute__((target("avx2")))
+		inline static std::size_t mulPointwiseAVX2(std::uint32_t *lhs, const std::uint32_t *rhs, std::size_t n,
+			std::uint32_t p){
+			const __m256i vp = _mm256_set1_epi32(static_cast<int>(p));
+			const __m256i vpInv = _mm256_set1_epi32(static_cast<int>(montgomeryNegInverse(p)));
+			const __m256i vr2 = _mm256_set1_epi32(static_cast<int>(montgomeryR2(p)));
+
+			std::size_t i = 0;
+			for(;i + 8 <= n;i += 8){
+				__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i));
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i));
+
+				__m256i even = redcAVX2(_mm256_mul_epu32(a, b), vp, vpInv);
+				even = redcAVX2(_mm256_mul_epu32(even, vr2), vp, vpInv);
+				__m256i odd = redcAVX2(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)), vp, vpInv);
+				odd = redcAVX2(_mm256_mul_epu32(odd, vr2), vp, vpInv);
+
+				__m256i r = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+				r = _mm256_min_epu32(r, _mm256_sub_epi32(r, vp));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(lhs + i), r);
+			}
+			return i;
+		}
+
+// GCC reports its own AVX-512 intrinsics as maybe using uninitialized values
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+		__attribute__((target("avx512f")))
+		inline static __m512i mulShoupAVX512(__m512i w, __m512i wq, __m512i y, __m512i p){
+			__m512i qEven = _mm512_srli_epi64(_mm512_mul_epu32(wq, y), 32);
+			__m512i qOdd = _mm512_mul_epu32(_mm512_srli_epi64(wq, 32), _mm512_srli_epi64(y, 32));
+			__m512i q = _mm512_mask_blend_epi32(0xAAAA, qEven, qOdd);
+			return _mm512_sub_epi32(_mm512_mullo_epi32(w, y), _mm512_mullo_epi32(q, p));
+		}
+
+		__attribute__((target("avx512f")))
+		inline static __m512i lazyAddAVX512(__m512i x, __m512i t, __m512i p2){
+			__m512i u = _mm512_sub_epi32(p2, t);
+			return _mm512_mask_sub_epi32(_mm512_add_epi32(x, t), _mm512_cmpge_epu32_mask(x, u), x, u);
+		}
+		__attribute__((target("avx512f")))
+		inline static __m512i lazySubAVX512(__m512i x, __m512i t, __m512i p2){
+			__m512i d = _mm512_sub_epi32(x, t);
+			return _mm512_mask_add_epi32(d, _mm512_cmplt_epu32_mask(x, t), d, p2);
+		}
+
+		template <bool DIF>
+		__attribute__((target("avx512f")))
+		inline static void nttPassAVX512(std::uint32_t *data, std::size_t sizeN, std::size_t mh,
+			std::size_t iBegin, std::size_t iEnd, const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+			const __m512i vp = _mm512_set1_epi32(static_cast<int>(p));
+			const __m512i vp2 = _mm512_set1_epi32(static_cast<int>(2 * p));
+
+			for(std::size_t j = 0;j < sizeN;j += (mh << 1)){
+				std::uint32_t *lo = data + j, *hi = data + (j + mh);
+				for(std::size_t i = iBegin;i < iEnd;i += 16){
+					__m512i x = _mm512_loadu_si512(lo + i);
+					__m512i y = _mm512_loadu_si512(hi + i);
+					__m512i vw = _mm512_loadu_si512(w + mh + i), vwq = _mm512_loadu_si512(wq + mh + i);
+					if(DIF){
+						_mm512_storeu_si512(lo + i, lazyAddAVX512(x, y, vp2));
+						_mm512_storeu_si512(hi + i, mulShoupAVX512(vw, vwq, lazySubAVX512(x, y, vp2), vp));
+					}
+					else{
+						__m512i t = mulShoupAVX512(vw, vwq, y, vp);
+						_mm512_storeu_si512(lo + i, lazyAddAVX512(x, t, vp2));
+						_mm512_storeu_si512(hi + i, lazySubAVX512(x, t, vp2));
+					}
+				}
+			}
+		}
+
+		// the passes with mh < 16, like nttSmallPassesAVX2
+		template <bool DIF>
+		__attribute__((target("avx512f")))
+		inline static void nttSmallPassesAVX512(std::uint32_t *data, std::size_t n,
+			const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+			const __m512i vp = _mm512_set1_epi32(static_cast<int>(p));
+			const __m512i vp2 = _mm512_set1_epi32(static_cast<int>(2 * p));
+			const __mmask16 upper[4] = {0xAAAA, 0xCCCC, 0xF0F0, 0xFF00};
+
+			__m512i lo[4], hi[4], vw[4], vwq[4];
+			for(int k = 0;k < 4;++k){
+				int mh = 1 << k;
+				alignas(64) std::uint32_t loIdx[16], hiIdx[16], laneW[16], laneWq[16];
+				for(int l = 0;l < 16;++l){
+					loIdx[l] = static_cast<std::uint32_t>(l & ~mh);
+					hiIdx[l] = static_cast<std::uint32_t>(l | mh);
+					laneW[l] = w[mh + (l & (mh - 1))];
+					laneWq[l] = wq[mh + (l & (mh - 1))];
+				}
+				lo[k] = _mm512_load_si512(loIdx);
+				hi[k] = _mm512_load_si512(hiIdx);
+				vw[k] = _mm512_load_si512(laneW);
+				vwq[k] = _mm512_load_si512(laneWq);
+			}
+
+			for(std::size_t i = 0;i < n;i += 16){
+				__m512i v = _mm512_loadu_si512(data + i);
+				for(int s = 0;s < 4;++s){
+					int k = DIF? (3 - s): s;
+					__m512i x = _mm512_permutexvar_epi32(lo[k], v);
+					__m512i y = _mm512_permutexvar_epi32(hi[k], v);
+					__m512i sum, diff;
+					if(DIF){
+						sum = lazyAddAVX512(x, y, vp2);
+						diff = mulShoupAVX512(vw[k], vwq[k], lazySubAVX512(x, y, vp2), vp);
+					}
+					else{
+						__m512i t = mulShoupAVX512(vw[k], vwq[k], y, vp);
+						sum = lazyAddAVX512(x, t, vp2);
+						diff = lazySubAVX512(x, t, vp2);
+					}
+					v = _mm512_mask_blend_epi32(upper[k], sum, diff);
+				}
+				_mm512_storeu_si512(data + i, v);
+			}
+		}
+
+		__attribute__((target("avx512f")))
+		inline static __m512i redcAVX512(__m512i t, __m512i p, __m512i pInv){
+			__m512i m = _mm512_mul_epu32(t, pInv);
+			return _mm512_srli_epi64(_mm512_add_epi64(t, _mm512_mul_epu32(m, p)), 32);
+		}
+
+		__attribute__((target("avx512f")))
+		inline static std::size_t mulPointwiseAVX512(std::uint32_t *lhs, const std::uint32_t *rhs, std::size_t n,
+			std::uint32_t p){
+			const __m512i vp = _mm512_set1_epi32(static_cast<int>(p));
+			const __m512i vpInv = _mm512_set1_epi32(static_cast<int>(montgomeryNegInverse(p)));
+			const __m512i vr2 = _mm512_set1_epi32(static_cast<int>(montgomeryR2(p)));
+
+			std::size_t i = 0;
+			for(;i + 16 <= n;i += 16){
+				__m512i a = _mm512_loadu_si512(lhs + i);
+				__m512i b = _mm512_loadu_si512(rhs + i);
+
+				__m512i even = redcAVX512(_mm512_mul_epu32(a, b), vp, vpInv);
+				even = redcAVX512(_mm512_mul_epu32(even, vr2), vp, vpInv);
+				__m512i odd = redcAVX512(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32)), vp, vpInv);
+				odd = redcAVX512(_mm512_mul_epu32(odd, vr2), vp, vpInv);
+
+				__m512i r = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+				r = _mm512_min_epu32(r, _mm512_sub_epi32(r, vp));
+				_mm512_storeu_si512(lhs + i, r);
+			}
+			return i;
+		}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // _BIG_NUM_X86_SIMD_
+
+		// runs a pass by the widest available kernel. Returns false if there is none,
+		// in which case the caller does it itself.
+		template <bool DIF>
+		inline static bool nttPassSIMD(std::uint32_t *data, std::size_t sizeN, std::size_t mh,
+			std::size_t iBegin, std::size_t iEnd, const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+#ifdef _BIG_NUM_X86_SIMD_
+			switch(simdLevel()){
+			case SIMDLevel::AVX512:
+				nttPassAVX512<DIF>(data, sizeN, mh, iBegin, iEnd, w, wq, p);
+				return true;
+			case SIMDLevel::AVX2:
+				nttPassAVX2<DIF>(data, sizeN, mh, iBegin, iEnd, w, wq, p);
+				return true;
+			default:
+				break;
+			}
+#endif // _BIG_NUM_X86_SIMD_
+			return false;
+		}
+
+		// runs the passes narrower than a vector over data[0, n), n being a multiple of
+		// simdLanes32(). Returns that width, or 1 if nothing was done.
+		template <bool DIF>
+		inline static std::size_t nttSmallPassesSIMD(std::uint32_t *data, std::size_t n,
+			const std::uint32_t *w, const std::uint32_t *wq, std::uint32_t p){
+#ifdef _BIG_NUM_X86_SIMD_
+			switch(simdLevel()){
+			case SIMDLevel::AVX512:
+				nttSmallPassesAVX512<DIF>(data, n, w, wq, p);
+				return 16;
+			case SIMDLevel::AVX2:
+				nttSmallPassesAVX2<DIF>(data, n, w, wq, p);
+				return 8;
+			default:
+				break;
+			}
+#endif // _BIG_NUM_X86_SIMD_
+			return 1;
+		}
+
+		// multiplies a prefix of lhs[0, n) by rhs[0, n) modulo p in place and returns
+		// its length. The remaining elements are left to the caller.
+		inline static std::size_t mulPointwiseSIMD(std::uint32_t *lhs, const std::uint32_t *rhs, std::size_t n,
+			std::uint32_t p){
+#ifdef _BIG_NUM_X86_SIMD_
+			switch(simdLevel()){
+			case SIMDLevel::AVX512:
+				return mulPointwiseAVX512(lhs, rhs, n, p);
+			case SIMDLevel::AVX2:
+				return mulPointwiseAVX2(lhs, rhs, n, p);
+			default:
+				break;
+			}
+#endif // _BIG_NUM_X86_SIMD_
+			return 0;
+		}
+
+	}; // namespace _utility
+
+}; // namespace bignum
+#endif // _BIG_NUM_SIMD_HPP_
@@ -0,0 +1,219 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_NUM_THREAD_HPP_
+#define _BIG_NUM_THREAD_HPP_
+
+#include <cstddef>
+#include <atomic>
+#include <exception>
+#include <utility>
+#include <vector>
+
+// Large transforms are split across threads. Define _BIG_NUM_NO_THREADS_ to keep
+// everything on the calling thread, e.g. when not linking with a thread library.
+#ifndef _BIG_NUM_NO_THREADS_
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#endif // _BIG_NUM_NO_THREADS_
+
+namespace bignum{
+
+	namespace _utility{
+
+		// external linkage, so that every translation unit shares the one setting
+		inline std::atomic<std::size_t> &threadCountSetting() noexcept{
+			static std::atomic<std::size_t> count(0);
+			return count;
+		}
+
+		// sets the number of threads used by large multiplications. 0 means one per
+		// hardware thread, which is the default.
+		inline void setThreadCount(std::size_t count) noexcept{
+			threadCountSetting().store(count);
+		}
+		inline std::size_t getThreadCount() noexcept{
+#ifndef _BIG_NUM_NO_THREADS_
+			std::size_t count = threadCountSetting().load();
+			if(0 == count){
+				count = std::thread::hardware_concurrency();
+			}
+			return (0 == count)? 1: count;
+#else
+			return 1;
+#endif // _BIG_NUM_NO_THREADS_
+		}
+
+#ifndef _BIG_NUM_NO_THREADS_
+		// Workers started once and kept for the whole program. A parallelFor() hands
+		// its indices to the calling thread and to whichever workers are free, so
+		// nested calls share the same threads instead of starting their own, and no
+		// more than getThreadCount() threads ever run at once.
+		class ThreadPool{
+		public:
+			// the indices of one parallelFor(), claimed one at a time
+			class Job{
+			public:
+				Job(std::size_t _n, std::function<void(std::size_t)> _func)
+					:n(_n), next(0), done(0), func(std::move(_func)){}
+
+				// claims and runs indices until none are left
+				void run(){
+					std::size_t finished = 0;
+					for(std::size_t i = next++;i < n;i = next++){
+						try{
+							func(i);
+						}
+						catch(...){
+							std::lock_guard<std::mutex> guard(lock);
+							if(!error){
+								error = std::current_exception();
+							}
+						}
+						++finished;
+					}
+					if((0 != finished) && (done.fetch_add(finished) + finished == n)){
+						std::lock_guard<std::mutex> guard(lock);
+						allDone.notify_all();
+					}
+				}
+
+				// waits for every index and rethrows the first exception thrown
+				void wait(){
+					std::unique_lock<std::mutex> guard(lock);
+					allDone.wait(guard, [this](){
+						return done.load() == n;
+					});
+					if(error){
+						std::rethrow_exception(error);
+					}
+				}
+			private:
+				std::size_t n;
+				std::atomic<std::size_t> next, done;
+				std::function<void(std::size_t)> func;
+				std::mutex lock;
+				std::condition_variable allDone;
+				std::exception_ptr error;
+			};
+
+			~ThreadPool(){
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					stop = true;
+				}
+				wakeUp.notify_all();
+				for(auto &worker: workers){
+					worker.join();
+				}
+			}
+
+			inline static ThreadPool &instance(){
+				static ThreadPool pool;
+				return pool;
+			}
+
+			// offers job to up to helpers workers, starting them as needed. Workers
+			// reaching it after the caller took every index find nothing left to do.
+			void submit(const std::shared_ptr<Job> &job, std::size_t helpers){
+				std::lock_guard<std::mutex> guard(lock);
+				try{
+					for(;workers.size() < helpers;){
+						workers.emplace_back([this](){
+							work();
+						});
+					}
+				}
+				catch(...){
+					// the caller takes over the indices of the missing workers
+				}
+				try{
+					for(std::size_t t = 0;(t < helpers) && (t < workers.size());++t){
+						jobs.push_back(job);
+					}
+				}
+				catch(...){}
+				wakeUp.notify_all();
+			}
+		private:
+			ThreadPool() = default;
+
+			void work(){
+				for(;;){
+					std::shared_ptr<Job> job;
+					{
+						std::unique_lock<std::mutex> guard(lock);
+						wakeUp.wait(guard, [this](){
+							return stop || !jobs.empty();
+						});
+						if(jobs.empty()){
+							return ;
+						}
+						job = std::move(jobs.front());
+						jobs.pop_front();
+					}
+					job->run();
+				}
+			}
+
+			std::mutex lock;
+			std::condition_variable wakeUp;
+			std::deque<std::shared_ptr<Job>> jobs;
+			std::vector<std::thread> workers;
+			bool stop = false;
+		};
+#endif // _BIG_NUM_NO_THREADS_
+
+		// calls func(i) for every i < n, spread over at most threads threads, the
+		// caller included. The first exception thrown by any call is rethrown after
+		// all of them finish.
+		template <typename Func>
+		inline static void parallelFor(std::size_t n, std::size_t threads, Func &&func){
+#ifndef _BIG_NUM_NO_THREADS_
+			if(threads > n){
+				threads = n;
+			}
+			if(threads > 1){
+				auto job = std::make_shared<ThreadPool::Job>(n, [&func](std::size_t i){
+					func(i);
+				});
+				ThreadPool::instance().submit(job, threads - 1);
+				job->run();
+				job->wait();
+				return ;
+			}
+#else
+			(void)threads;
+#endif // _BIG_NUM_NO_THREADS_
+			for(std::size_t i = 0;i < n;++i){
+				func(i);
+			}
+		}
+
+		// calls f0() and f1(), concurrently if parallel is set
+		template <typename Func0, typename Func1>
+		inline static void parallelInvoke(bool parallel, Func0 &&f0, Func1 &&f1){
+			if(parallel){
+				parallelFor(2, 2, [&f0, &f1](std::size_t i){
+					if(0 == i){
+						f0();
+					}
+					else{
+						f1();
+					}
+				});
+				return ;
+			}
+			f0();
+			f1();
+		}
+
+	}; // namespace _utility
+
+}; // namespace bignum
+#endif // _BIG_NUM_THREAD_HPP_
@@ -69,6 +69,27 @@ namespace bignum{
 		struct squareType<uint32_t>{
 			using type = uint64_t;
 		};
+#ifdef __SIZEOF_INT128__
+		template <>
+		struct squareType<int64_t>{
+			using type = __int128;
+		};
+		template <>
+		struct squareType<uint64_t>{
+			using type = unsigned __int128;
+		};
+#endif // __SIZEOF_INT128__
+		
+		template <typename T>
+		struct SFINAEWrapperVoid{
+			using type = void;
+		};
+		
+		template <typename T, typename SFINAE = void>
+		struct hasSquareType:public std::false_type{};
+		template <typename T>
+		struct hasSquareType<T, typename SFINAEWrapperVoid<typename squareType<T>::type>::type>
+			:public std::true_type{};
 		
 		template <class T1, class T2, typename SFINAE1 = void, typename SFINAE2 = void>
 		struct conj2;
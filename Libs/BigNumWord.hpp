@@ -0,0 +1,513 @@
+#ifndef _BIG_NUM_HPP_
+#error "This header must be included through BigNum.hpp"
+#endif // _BIG_NUM_HPP_
+
+#ifndef _BIG_NUM_WORD_HPP_
+#define _BIG_NUM_WORD_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "BigNumTypeTrait.hpp"
+
+namespace bignum{
+
+	namespace _utility{
+
+		// full machine word arithmetic. All digits are unsigned and use every bit of
+		// the word, so carries have to be propagated by hand instead of being kept in
+		// some spare high bits.
+
+		template <typename Word>
+		inline Word addWithCarry(Word _lhs, Word _rhs, Word &carry) noexcept{
+			Word sum = _lhs + carry;
+			Word c = static_cast<Word>(sum < carry);
+			sum += _rhs;
+			carry = c + static_cast<Word>(sum < _rhs);
+			return sum;
+		}
+
+		template <typename Word>
+		inline Word subWithBorrow(Word _lhs, Word _rhs, Word &borrow) noexcept{
+			Word diff = _lhs - _rhs;
+			Word b = static_cast<Word>(_lhs < _rhs);
+			b += static_cast<Word>(diff < borrow);
+			diff -= borrow;
+			borrow = b;
+			return diff;
+		}
+
+		// case for words having a native double-width type, i.e. 64x64->128 on
+		// gcc/clang x86_64 targets
+		template <typename Word>
+		inline Word mulFullImpl(Word _lhs, Word _rhs, Word &high, std::true_type) noexcept{
+			using Wide = typename _type::squareType<Word>::type;
+			Wide res = static_cast<Wide>(_lhs) * static_cast<Wide>(_rhs);
+			high = static_cast<Word>(res >> std::numeric_limits<Word>::digits);
+			return static_cast<Word>(res);
+		}
+		// portable fallback using half words
+		template <typename Word>
+		inline Word mulFullImpl(Word _lhs, Word _rhs, Word &high, std::false_type) noexcept{
+			constexpr int HALF = std::numeric_limits<Word>::digits / 2;
+			constexpr Word MASK = (Word(1) << HALF) - 1;
+
+			Word l0 = _lhs & MASK, l1 = _lhs >> HALF;
+			Word r0 = _rhs & MASK, r1 = _rhs >> HALF;
+			Word p00 = l0 * r0, p01 = l0 * r1, p10 = l1 * r0, p11 = l1 * r1;
+
+			Word mid = (p00 >> HALF) + (p01 & MASK) + (p10 & MASK);
+			high = p11 + (p01 >> HALF) + (p10 >> HALF) + (mid >> HALF);
+			return (mid << HALF) | (p00 & MASK);
+		}
+
+		// returns the low word of _lhs * _rhs, and stores the high word in high
+		template <typename Word>
+		inline Word mulFull(Word _lhs, Word _rhs, Word &high) noexcept{
+			return mulFullImpl(_lhs, _rhs, high,
+				std::integral_constant<bool, _type::hasSquareType<Word>::value>{});
+		}
+
+		// case for words having a native double-width type
+		template <typename Word>
+		inline Word divFullImpl(Word high, Word low, Word divisor, Word &rem, std::true_type) noexcept{
+			using Wide = typename _type::squareType<Word>::type;
+			Wide num = (static_cast<Wide>(high) << std::numeric_limits<Word>::digits) | low;
+			rem = static_cast<Word>(num % divisor);
+			return static_cast<Word>(num / divisor);
+		}
+		// portable fallback, bit by bit restoring division
+		template <typename Word>
+		inline Word divFullImpl(Word high, Word low, Word divisor, Word &rem, std::false_type) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			Word q(0);
+			for(int i = BITS - 1;i >= 0;--i){
+				Word top = high >> (BITS - 1);
+				high = (high << 1) | ((low >> i) & 1);
+				q <<= 1;
+				if((top != 0) || (high >= divisor)){
+					high -= divisor;
+					q |= 1;
+				}
+			}
+			rem = high;
+			return q;
+		}
+
+		// (high, low) / divisor, assumes high < divisor
+		template <typename Word>
+		inline Word divFull(Word high, Word low, Word divisor, Word &rem) noexcept{
+			return divFullImpl(high, low, divisor, rem,
+				std::integral_constant<bool, _type::hasSquareType<Word>::value>{});
+		}
+
+		// floor((beta ^ 2 - 1) / d) - beta for a normalized d, i.e. one with the highest
+		// bit set, with beta = 2 ^ BITS
+		template <typename Word>
+		inline Word reciprocalWord(Word d) noexcept{
+			Word rem;
+			return divFull(static_cast<Word>(~d), static_cast<Word>(~Word(0)), d, rem);
+		}
+
+		// (high, low) / d given v = reciprocalWord(d), assumes high < d. The quotient
+		// comes from the product v * high with at most two adjustments (Moller and
+		// Granlund, "Improved division by invariant integers").
+		template <typename Word>
+		inline Word divFullPreinv(Word high, Word low, Word d, Word v, Word &rem) noexcept{
+			Word q1;
+			Word q0 = mulFull(v, high, q1);
+			q0 += low;
+			q1 += high + Word(1) + static_cast<Word>(q0 < low);
+
+			Word r = low - q1 * d;
+			if(r > q0){
+				--q1;
+				r += d;
+			}
+			if(r >= d){
+				++q1;
+				r -= d;
+			}
+			rem = r;
+			return q1;
+		}
+
+		template <typename Word>
+		inline int countLeadingZero(Word w) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			if(w == 0){
+				return BITS;
+			}
+			int res = 0;
+			for(int sh = BITS >> 1;sh > 0;sh >>= 1){
+				if((w >> (BITS - sh)) == 0){
+					res += sh;
+					w <<= sh;
+				}
+			}
+			return res;
+		}
+
+		// res[0, n) = _lhs[0, n) + _rhs[0, n), returns the carry
+		template <typename Word, typename SizeT>
+		inline Word addDigits(Word *res, const Word *_lhs, const Word *_rhs, SizeT n) noexcept{
+			Word carry(0);
+			for(SizeT i(0);i < n;++i){
+				res[i] = addWithCarry(_lhs[i], _rhs[i], carry);
+			}
+			return carry;
+		}
+
+		// res[0, n) = _lhs[0, n) + carry, returns the carry
+		template <typename Word, typename SizeT>
+		inline Word addDigit(Word *res, const Word *_lhs, SizeT n, Word carry) noexcept{
+			SizeT i(0);
+			for(;(i < n) && (carry != Word(0));++i){
+				res[i] = _lhs[i] + carry;
+				carry = static_cast<Word>(res[i] < carry);
+			}
+			if(res != _lhs){
+				for(;i < n;++i){
+					res[i] = _lhs[i];
+				}
+			}
+			return carry;
+		}
+
+		// res[0, n) = _lhs[0, n) - _rhs[0, n), returns the borrow
+		template <typename Word, typename SizeT>
+		inline Word subDigits(Word *res, const Word *_lhs, const Word *_rhs, SizeT n) noexcept{
+			Word borrow(0);
+			for(SizeT i(0);i < n;++i){
+				res[i] = subWithBorrow(_lhs[i], _rhs[i], borrow);
+			}
+			return borrow;
+		}
+
+		// res[0, n) = _lhs[0, n) - borrow, returns the borrow
+		template <typename Word, typename SizeT>
+		inline Word subDigit(Word *res, const Word *_lhs, SizeT n, Word borrow) noexcept{
+			SizeT i(0);
+			for(;(i < n) && (borrow != Word(0));++i){
+				Word cur = _lhs[i];
+				res[i] = cur - borrow;
+				borrow = static_cast<Word>(cur < borrow);
+			}
+			if(res != _lhs){
+				for(;i < n;++i){
+					res[i] = _lhs[i];
+				}
+			}
+			return borrow;
+		}
+
+		// res[0, n) = _lhs[0, n) * _rhs, returns the high digit
+		template <typename Word, typename SizeT>
+		inline Word mulDigit(Word *res, const Word *_lhs, SizeT n, Word _rhs) noexcept{
+			Word carry(0);
+			for(SizeT i(0);i < n;++i){
+				Word high;
+				Word low = mulFull(_lhs[i], _rhs, high);
+				low += carry;
+				carry = high + static_cast<Word>(low < carry);
+				res[i] = low;
+			}
+			return carry;
+		}
+
+		// res[0, n) += _lhs[0, n) * _rhs, returns the high digit
+		template <typename Word, typename SizeT>
+		inline Word addMulDigit(Word *res, const Word *_lhs, SizeT n, Word _rhs) noexcept{
+			Word carry(0);
+			for(SizeT i(0);i < n;++i){
+				Word high;
+				Word low = mulFull(_lhs[i], _rhs, high);
+				low += carry;
+				high += static_cast<Word>(low < carry);
+				res[i] += low;
+				carry = high + static_cast<Word>(res[i] < low);
+			}
+			return carry;
+		}
+
+		// res[0, n) -= _lhs[0, n) * _rhs, returns the high digit to be subtracted
+		template <typename Word, typename SizeT>
+		inline Word subMulDigit(Word *res, const Word *_lhs, SizeT n, Word _rhs) noexcept{
+			Word carry(0);
+			for(SizeT i(0);i < n;++i){
+				Word high;
+				Word low = mulFull(_lhs[i], _rhs, high);
+				low += carry;
+				high += static_cast<Word>(low < carry);
+				carry = high + static_cast<Word>(res[i] < low);
+				res[i] -= low;
+			}
+			return carry;
+		}
+
+		// res[0, n) = _lhs[0, n) << bits for 0 < bits < BITS and n > 0, returns the bits
+		// shifted out
+		template <typename Word, typename SizeT>
+		inline Word shlDigits(Word *res, const Word *_lhs, SizeT n, int bits) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			Word high = static_cast<Word>(_lhs[n - 1] >> (BITS - bits));
+			for(SizeT i = n - 1;i > 0;--i){
+				res[i] = static_cast<Word>(_lhs[i] << bits) | static_cast<Word>(_lhs[i - 1] >> (BITS - bits));
+			}
+			res[0] = static_cast<Word>(_lhs[0] << bits);
+			return high;
+		}
+		// res[0, n) = _lhs[0, n) >> bits for 0 < bits < BITS
+		template <typename Word, typename SizeT>
+		inline void shrDigits(Word *res, const Word *_lhs, SizeT n, int bits) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			for(SizeT i(0);i + 1 < n;++i){
+				res[i] = static_cast<Word>(_lhs[i] >> bits) | static_cast<Word>(_lhs[i + 1] << (BITS - bits));
+			}
+			if(n > 0){
+				res[n - 1] = static_cast<Word>(_lhs[n - 1] >> bits);
+			}
+		}
+
+		// the inverse of an odd d modulo 2^{BITS}
+		template <typename Word>
+		inline Word inverseWord(Word d) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			// Newton's iteration, d * d == 1 mod 8 and the precision doubles each time
+			Word inv = d;
+			for(int prec = 3;prec < BITS;prec *= 2){
+				inv = static_cast<Word>(inv * static_cast<Word>(Word(2) - static_cast<Word>(d * inv)));
+			}
+			return inv;
+		}
+
+		// res[0, n) = _lhs[0, n) / d, assuming d is odd and divides _lhs[0, n) exactly.
+		// Every quotient digit is obtained by a multiplication with the inverse of d
+		// modulo 2^{BITS} instead of a division (Jebelean's exact division).
+		template <typename Word, typename SizeT>
+		inline void divExactDigit(Word *res, const Word *_lhs, SizeT n, Word d) noexcept{
+			Word inv = inverseWord(d);
+
+			Word borrow(0);
+			for(SizeT i(0);i < n;++i){
+				Word cur = _lhs[i];
+				Word x = cur - borrow;
+				borrow = static_cast<Word>(cur < borrow);
+				Word q = static_cast<Word>(x * inv);
+				res[i] = q;
+
+				Word high;
+				mulFull(q, d, high);
+				borrow += high;
+			}
+		}
+
+		// res[0, lLen + rLen) = _lhs[0, lLen) * _rhs[0, rLen) by product scanning (Comba),
+		// i.e. every column of partial products is summed up in a three-word
+		// accumulator before being stored. res must not overlap with the operands.
+		template <typename Word, typename SizeT>
+		inline void mulDigits(Word *res, const Word *_lhs, SizeT lLen, const Word *_rhs, SizeT rLen) noexcept{
+			Word c0(0), c1(0), c2(0);
+			for(SizeT k(0);k + 1 < lLen + rLen;++k){
+				SizeT iMin = (k >= rLen)? (k - rLen + 1): SizeT(0);
+				SizeT iMax = (k < lLen)? k: (lLen - 1);
+				for(SizeT i = iMin;i <= iMax;++i){
+					Word high;
+					Word low = mulFull(_lhs[i], _rhs[k - i], high);
+					c0 += low;
+					// the high word of a full product is at most 2^{BITS} - 2
+					high += static_cast<Word>(c0 < low);
+					c1 += high;
+					c2 += static_cast<Word>(c1 < high);
+				}
+				res[k] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = Word(0);
+			}
+			res[lLen + rLen - 1] = c0;
+		}
+
+		// scratch words needed by mulKaratsuba
+		template <typename SizeT>
+		inline SizeT karatsubaScratchLen(SizeT n, SizeT threshold) noexcept{
+			SizeT res(0);
+			for(;(n >= threshold) && (n > 1);n -= n / 2){
+				res += 4 * (n - n / 2) + 1;
+			}
+			return res;
+		}
+
+		// res[0, 2n) = _lhs[0, n) * _rhs[0, n) by Karatsuba's method, falling back to
+		// mulDigits below threshold digits. Only sums of halves are multiplied, i.e.
+		// a0 * b1 + a1 * b0 = (a0 + a1) * (b0 + b1) - a0 * b0 - a1 * b1, so that
+		// no signs are involved. res must not overlap with the operands, and scratch
+		// must hold karatsubaScratchLen(n, threshold) words.
+		template <typename Word, typename SizeT>
+		inline void mulKaratsuba(Word *res, const Word *_lhs, const Word *_rhs, SizeT n, Word *scratch, SizeT threshold) noexcept{
+			if((n < threshold) || (n <= 1)){
+				mulDigits(res, _lhs, n, _rhs, n);
+				return ;
+			}
+
+			// the low halves have l digits and the high halves have h >= l digits
+			SizeT l = n / 2, h = n - l;
+			Word *lSum = scratch, *rSum = scratch + h, *mid = scratch + 2 * h;
+			Word *next = mid + (2 * h + 1);
+
+			mulKaratsuba(res, _lhs, _rhs, l, next, threshold);
+			mulKaratsuba(res + 2 * l, _lhs + l, _rhs + l, h, next, threshold);
+
+			Word lCarry = addDigits(lSum, _lhs + l, _lhs, l);
+			lCarry = addDigit(lSum + l, _lhs + 2 * l, h - l, lCarry);
+			Word rCarry = addDigits(rSum, _rhs + l, _rhs, l);
+			rCarry = addDigit(rSum + l, _rhs + 2 * l, h - l, rCarry);
+
+			// mid[0, 2h + 1) = (lSum + lCarry * beta^h) * (rSum + rCarry * beta^h)
+			mulKaratsuba(mid, lSum, rSum, h, next, threshold);
+			mid[2 * h] = lCarry & rCarry;
+			if(Word(0) != lCarry){
+				mid[2 * h] += addDigits(mid + h, mid + h, rSum, h);
+			}
+			if(Word(0) != rCarry){
+				mid[2 * h] += addDigits(mid + h, mid + h, lSum, h);
+			}
+
+			Word borrow = subDigits(mid, mid, res, 2 * l);
+			subDigit(mid + 2 * l, mid + 2 * l, 2 * (h - l) + 1, borrow);
+			borrow = subDigits(mid, mid, res + 2 * l, 2 * h);
+			subDigit(mid + 2 * h, mid + 2 * h, SizeT(1), borrow);
+
+			Word carry = addDigits(res + l, res + l, mid, 2 * h + 1);
+			addDigit(res + (l + 2 * h + 1), res + (l + 2 * h + 1), l - 1, carry);
+		}
+
+		// 1 - _lhs > _rhs
+		// 0 - _lhs == _rhs
+		// -1 - _lhs < _rhs
+		template <typename Word, typename SizeT>
+		inline int compareDigits(const Word *_lhs, const Word *_rhs, SizeT n) noexcept{
+			for(SizeT i = n;i > 0;--i){
+				if(_lhs[i - 1] != _rhs[i - 1]){
+					return (_lhs[i - 1] > _rhs[i - 1])? 1: -1;
+				}
+			}
+			return 0;
+		}
+
+		// Montgomery reduction: res[0, n) = t[0, 2n) / 2^{BITS * n} mod m[0, n) for an odd
+		// m and t < m * 2^{BITS * n}, with mInv = -1 / m[0] modulo 2^{BITS}. Each step
+		// adds the multiple of m that clears the lowest digit of t, which is
+		// overwritten. res may be t + n.
+		template <typename Word, typename SizeT>
+		inline void redcDigits(Word *res, Word *t, const Word *m, SizeT n, Word mInv) noexcept{
+			Word top(0);
+			for(SizeT i(0);i < n;++i){
+				Word u = static_cast<Word>(t[i] * mInv);
+				Word carry = addMulDigit(t + i, m, n, u);
+				t[i + n] = addWithCarry(t[i + n], carry, top);
+			}
+
+			// t / 2^{BITS * n} < 2m
+			if((Word(0) != top) || (compareDigits(t + n, m, n) >= 0)){
+				subDigits(res, t + n, m, n);
+			}
+			else if(res != t + n){
+				for(SizeT i(0);i < n;++i){
+					res[i] = t[i + n];
+				}
+			}
+		}
+
+		// res[0, 2n) = _lhs[0, n) ^ 2 by product scanning. Every product of two distinct
+		// digits appears twice in its column, so they are summed once and the sum is
+		// doubled before the square of the middle digit is added.
+		template <typename Word, typename SizeT>
+		inline void sqrDigits(Word *res, const Word *_lhs, SizeT n) noexcept{
+			constexpr int BITS = std::numeric_limits<Word>::digits;
+
+			Word c0(0), c1(0), c2(0);
+			for(SizeT k(0);k + 1 < 2 * n;++k){
+				SizeT iMin = (k >= n)? (k - n + 1): SizeT(0);
+				Word t0(0), t1(0), t2(0);
+				for(SizeT i = iMin;2 * i < k;++i){
+					Word high;
+					Word low = mulFull(_lhs[i], _lhs[k - i], high);
+					t0 += low;
+					high += static_cast<Word>(t0 < low);
+					t1 += high;
+					t2 += static_cast<Word>(t1 < high);
+				}
+				t2 = static_cast<Word>((t2 << 1) | (t1 >> (BITS - 1)));
+				t1 = static_cast<Word>((t1 << 1) | (t0 >> (BITS - 1)));
+				t0 = static_cast<Word>(t0 << 1);
+				if(0 == k % 2){
+					Word high;
+					Word low = mulFull(_lhs[k / 2], _lhs[k / 2], high);
+					t0 += low;
+					high += static_cast<Word>(t0 < low);
+					t1 += high;
+					t2 += static_cast<Word>(t1 < high);
+				}
+
+				c0 += t0;
+				t1 += static_cast<Word>(c0 < t0);
+				t2 += static_cast<Word>(t1 < static_cast<Word>(c0 < t0));
+				c1 += t1;
+				c2 += t2 + static_cast<Word>(c1 < t1);
+				res[k] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = Word(0);
+			}
+			res[2 * n - 1] = c0;
+		}
+
+		// res[0, 2n) = _lhs[0, n) ^ 2 by Karatsuba's method, where the middle term is
+		// a0 ^ 2 + a1 ^ 2 - (a1 - a0) ^ 2. The difference is taken in absolute value as
+		// its sign does not matter. Requirements are those of mulKaratsuba.
+		template <typename Word, typename SizeT>
+		inline void sqrKaratsuba(Word *res, const Word *_lhs, SizeT n, Word *scratch, SizeT threshold) noexcept{
+			if((n < threshold) || (n <= 1)){
+				sqrDigits(res, _lhs, n);
+				return ;
+			}
+
+			SizeT l = n / 2, h = n - l;
+			Word *mid = scratch, *diff = scratch + 2 * h, *next = scratch + 3 * h;
+
+			sqrKaratsuba(res, _lhs, l, next, threshold);
+			sqrKaratsuba(res + 2 * l, _lhs + l, h, next, threshold);
+
+			// diff = |a1 - a0|, a0 being padded to h digits
+			if(((h > l) && (Word(0) != _lhs[l + h - 1])) || (compareDigits(_lhs + l, _lhs, l) >= 0)){
+				Word borrow = subDigits(diff, _lhs + l, _lhs, l);
+				subDigit(diff + l, _lhs + 2 * l, h - l, borrow);
+			}
+			else{
+				subDigits(diff, _lhs, _lhs + l, l);
+				diff[h - 1] = (h > l)? Word(0): diff[h - 1];
+			}
+			sqrKaratsuba(mid, diff, h, next, threshold);
+
+			// sum[0, 2h + 1) = a0 ^ 2 + a1 ^ 2 - mid, overwriting diff
+			Word *sum = scratch + 2 * h;
+			Word carry = addDigits(sum, res + 2 * l, res, 2 * l);
+			sum[2 * h] = addDigit(sum + 2 * l, res + 4 * l, 2 * (h - l), carry);
+			Word borrow = subDigits(sum, sum, mid, 2 * h);
+			sum[2 * h] -= borrow;
+
+			carry = addDigits(res + l, res + l, sum, 2 * h + 1);
+			addDigit(res + (l + 2 * h + 1), res + (l + 2 * h + 1), l - 1, carry);
+		}
+
+	}; // namespace bignum::_utility
+
+}; // namespace bignum
+#endif // _BIG_NUM_WORD_HPP_
@@ -0,0 +1,92 @@
+// products of numbers with the same magnitude and opposite signs, which take the
+// squaring path
+//
+// g++ -std=c++14 -I.. MultiplySign.cpp -o MultiplySign && ./MultiplySign
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "../BigNum.hpp"
+
+using namespace bignum;
+
+namespace{
+
+	int failures = 0;
+
+	void check(bool cond, const char *what){
+		if(!cond){
+			std::cerr << "FAILED: " << what << std::endl;
+			++failures;
+		}
+	}
+
+	std::string toString(const bigint_t &x){
+		std::ostringstream out;
+		out << x;
+		return out.str();
+	}
+
+	// 2^{bits} - 1
+	bigint_t allOnes(unsigned bits){
+		bigint_t x(1);
+		x <<= bits;
+		x -= 1;
+		return x;
+	}
+
+	// a, b = -a and a ^ 2 through every overload, for a > 0
+	void checkMixedSigns(const bigint_t &a, const char *name){
+		bigint_t b = -a;
+		bigint_t sq = a * a;
+		std::string neg = "-" + toString(sq);
+
+		check(sq > 0, name);
+		// multiply(const BigInt &)
+		check(toString(a * b) == neg, name);
+		check(toString(b * a) == neg, name);
+		check(toString(b * b) == toString(sq), name);
+		// multiply(BigInt &&)
+		check(toString(bigint_t(a) * bigint_t(b)) == neg, name);
+		check(toString(bigint_t(b) * bigint_t(a)) == neg, name);
+		check(toString(bigint_t(b) * bigint_t(b)) == toString(sq), name);
+
+		// operator*=
+		bigint_t x = a;
+		x *= b;
+		check(toString(x) == neg, name);
+		x = b;
+		x *= a;
+		check(toString(x) == neg, name);
+		x = a;
+		x *= bigint_t(b);
+		check(toString(x) == neg, name);
+		x = b;
+		x *= bigint_t(a);
+		check(toString(x) == neg, name);
+		x = b;
+		x *= x;
+		check(toString(x) == toString(sq), name);
+	}
+
+};
+
+int main(){
+	check(toString(123456789_bigint * -123456789_bigint) == "-15241578750190521", "literals");
+
+	// the basecase, Toom-Cook and NTT tiers
+	checkMixedSigns(123456789_bigint, "one digit");
+	checkMixedSigns(allOnes(64 * 20), "20 digits");
+	checkMixedSigns(allOnes(64 * 300), "300 digits");
+	checkMixedSigns(allOnes(100000), "100000 bits");
+
+	if(0 != failures){
+		std::cerr << failures << " check(s) failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "all passed" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+// integer roots and perfect powers against brute force: isqrtRem around squares,
+// iroot for every degree up to the bit length and isPerfectPower on small numbers,
+// signed powers and a large random number
+//
+// g++ -std=c++14 -O2 -I.. PerfectPower.cpp -o PerfectPower && ./PerfectPower
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+
+#include "../BigNum.hpp"
+
+using namespace bignum;
+
+namespace{
+
+	int failures = 0;
+
+	void check(bool cond, const char *what){
+		if(!cond){
+			std::cerr << "FAILED: " << what << std::endl;
+			++failures;
+		}
+	}
+
+	std::mt19937_64 gen(2024);
+
+	bigint_t randomNumber(unsigned digits){
+		bigint_t x(0);
+		for(unsigned i = 0;i < digits;++i){
+			x <<= 64;
+			x += bigint_t(static_cast<unsigned long long>(gen()));
+		}
+		return x;
+	}
+
+	// 2^{bits}
+	bigint_t power2(unsigned bits){
+		bigint_t x(1);
+		x <<= bits;
+		return x;
+	}
+
+	// n = s^2 + r with 0 <= r <= 2s
+	void checkSqrtRem(const bigint_t &n, const bigint_t &s, const char *name){
+		std::pair<bigint_t, bigint_t> sr = isqrtRem(n);
+		check(sr.first == s, name);
+		check(sr.first * sr.first + sr.second == n, name);
+		check(isqrt(n) == s, name);
+	}
+
+	void checkSquares(const bigint_t &k){
+		bigint_t k2 = k * k;
+		checkSqrtRem(k2, k, "isqrtRem(k^2)");
+		checkSqrtRem(k2 - 1, k - 1, "isqrtRem(k^2 - 1)");
+		checkSqrtRem(k2 + 1, k, "isqrtRem(k^2 + 1)");
+		checkSqrtRem(k2 + (k << 1), k, "isqrtRem(k^2 + 2k)");
+		check(isPerfectSquare(k2), "isPerfectSquare(k^2)");
+		// 0 = 1^2 - 1 is a square
+		check(!isPerfectSquare(k2 - 1) || (k == 1), "isPerfectSquare(k^2 - 1)");
+		check(!isPerfectSquare(k2 + 1), "isPerfectSquare(k^2 + 1)");
+	}
+
+	// r^k <= |n| < (r + 1)^k for r = |iroot(n, k)|, for every k up to past the
+	// bit length of n
+	void checkRoots(const bigint_t &n){
+		unsigned lenBin = 0;
+		for(bigint_t m = n;m > 0;m >>= 1){
+			++lenBin;
+		}
+		for(unsigned k = 1;k <= lenBin + 2;++k){
+			bigint_t r = iroot(n, k);
+			check((pow(r, k) <= n) && (n < pow(r + 1, k)), "iroot bounds");
+			if(1 == k % 2){
+				check(iroot(-n, k) == -r, "iroot of a negative number");
+			}
+		}
+	}
+
+	// x^k - 1, x^k and x^k + 1 for the root x
+	void checkExactRoot(const bigint_t &x, unsigned k){
+		bigint_t n = pow(x, k);
+		check(iroot(n, k) == x, "iroot(x^k)");
+		check(iroot(n - 1, k) == x - 1, "iroot(x^k - 1)");
+		check(iroot(n + 1, k) == x, "iroot(x^k + 1)");
+	}
+
+};
+
+int main(){
+	// isqrtRem near k^2 and k^2 - 1
+	for(unsigned long long k = 1;k < 3000;++k){
+		checkSquares(bigint_t(k));
+	}
+	for(unsigned digits: {1u, 2u, 5u, 40u, 300u, 3000u}){
+		checkSquares(randomNumber(digits));
+		checkSquares(power2(64 * digits));
+		checkSquares(power2(64 * digits) - 1);
+	}
+
+	// iroot for every degree up to the bit length
+	for(unsigned long long n = 1;n < 300;++n){
+		checkRoots(bigint_t(n));
+	}
+	for(unsigned digits: {1u, 2u, 4u, 9u}){
+		checkRoots(randomNumber(digits));
+		checkRoots(power2(64 * digits));
+		checkRoots(power2(64 * digits) - 1);
+	}
+	for(unsigned k: {3u, 5u, 7u, 64u, 101u}){
+		checkExactRoot(bigint_t(3), k);
+		checkExactRoot(randomNumber(3), k);
+		checkExactRoot(randomNumber(40), k);
+	}
+
+	// isPerfectPower for |n| < 2^{16} against every power in range
+	std::set<long long> powers{0, 1, -1};
+	for(long long x = 2;x * x < 65536;++x){
+		long long y = x;
+		for(unsigned k = 2;y * x < 65536;++k){
+			y *= x;
+			powers.insert(y);
+			if(1 == k % 2){
+				powers.insert(-y);
+			}
+		}
+	}
+	for(long long n = -65535;n < 65536;++n){
+		if(isPerfectPower(bigint_t(n)) != (powers.count(n) != 0)){
+			std::cerr << "FAILED: isPerfectPower(" << n << ")" << std::endl;
+			++failures;
+		}
+	}
+
+	check(isPerfectPower(bigint_t(-8)), "-8");
+	check(!isPerfectPower(bigint_t(-4)), "-4");
+	check(isPerfectPower(bigint_t(0)) && isPerfectPower(bigint_t(1)) && isPerfectPower(bigint_t(-1)), "0, 1 and -1");
+	check(isPerfectPower(-power2(63)), "-2^63");
+	check(!isPerfectPower(-power2(64)), "-2^64");
+	for(unsigned p = 2;p < 3000;++p){
+		check(isPerfectPower(power2(p)), "2^p");
+		// -2^p = (-2^{p / k})^k for an odd k > 1 dividing p
+		check(isPerfectPower(-power2(p)) == (0 != (p & (p - 1))), "-2^p");
+		check(!isPerfectPower(power2(p) + 1) || (3 == p), "2^p + 1");
+	}
+
+	// powers with and without small factors, through trial division and through
+	// the residue tests
+	bigint_t odd = randomNumber(20);
+	if(odd % 2u == 0u){
+		odd += 1;
+	}
+	for(unsigned k: {3u, 5u, 7u, 11u, 13u, 97u, 101u}){
+		check(isPerfectPower(pow(odd, k)), "odd x^k");
+		check(isPerfectPower(-pow(odd, k)), "-(odd x^k)");
+		check(!isPerfectPower(pow(odd, k) + 2), "odd x^k + 2");
+		check(isPerfectPower(pow(odd * bigint_t(3), k)), "(3x)^k");
+		check(!isPerfectPower(pow(odd * bigint_t(3), k) * bigint_t(3)), "3 (3x)^k");
+		check(isPerfectPower(pow(bigint_t(3), k) * pow(bigint_t(5), k)), "15^k");
+	}
+	check(isPerfectPower(-pow(odd, 6)), "-(x^6)");
+	check(!isPerfectPower(-pow(odd, 4)), "-(x^4)");
+	check(isPerfectPower(pow(bigint_t(65537), 400) * pow(bigint_t(65539), 100)), "large prime factors");
+
+	// a random 16384-digit number, which is no power, and a cube of that size.
+	// The power tests should stay within a few square roots.
+	bigint_t n = randomNumber(16384);
+	if(n % 2u == 0u){
+		n += 1;
+	}
+	auto start = std::chrono::steady_clock::now();
+	bigint_t s = isqrt(n);
+	double sqrtTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	check((s * s <= n) && (n < (s + 1) * (s + 1)), "isqrt of 16384 digits");
+	start = std::chrono::steady_clock::now();
+	check(!isPerfectPower(n), "random 16384 digits");
+	double powerTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "16384 digits: isqrt " << sqrtTime << " s, isPerfectPower " << powerTime << " s" << std::endl;
+	check(powerTime < 50 * sqrtTime + 0.1, "isPerfectPower time");
+	bigint_t x = randomNumber(16384 / 3);
+	check(isPerfectPower(pow(x, 3)), "16384-digit cube");
+	check(!isPerfectPower(pow(x, 3) + 2), "16384-digit cube + 2");
+
+	if(0 != failures){
+		std::cerr << failures << " check(s) failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << "all passed" << std::endl;
+	return EXIT_SUCCESS;
+}